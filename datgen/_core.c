@@ -0,0 +1,335 @@
+/*****************************************************************
+** datgen._core: the C generator (libdatgen) inside Python.     **
+**                                                              **
+** Generator(**config) builds the data dictionary, the rule     **
+** base and the match index once; the keywords are the fields   **
+** of struct datgen_config (see src/datgen.h). clone() gives    **
+** another Generator on the same rule base, for another thread. **
+**                                                              **
+** fill(buffers, n) creates the next n objects straight into    **
+** writable buffers, one per column: int32 for the nominal and  **
+** ordinal attributes and the class, float32 for the continuous **
+** ones. NumPy arrays serve, so the values are never copied.    **
+** The GIL is released while the objects are created.           **
+*****************************************************************/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "datgen.h"
+
+
+static PyObject *ConstrainedError ;
+static PyTypeObject GeneratorType ;
+
+typedef struct {
+    PyObject_HEAD
+    struct datgen *generator ;
+    int busy ;			/* a fill() runs without the GIL */
+} Generator ;
+
+
+/*************************************
+** Raise the exception that stands for a libdatgen error code.
+*************************************/
+static PyObject *
+raise_code(int code, const char *what)
+{
+    if (code == DATGEN_CONSTRAINED)
+        PyErr_Format(ConstrainedError, "%s: the domain appears to be too constrained", what) ;
+    else if (code == DATGEN_PARAMETER)
+        PyErr_Format(PyExc_ValueError, "%s: parameter problem", what) ;
+    else
+        PyErr_Format(PyExc_RuntimeError, "%s failed [%d]", what, code) ;
+    return NULL ;
+}
+
+
+static int
+Generator_init(Generator *self, PyObject *args, PyObject *kwds)
+{
+    static char *keywords[] = {
+        "relevant", "irrelevant", "masked", "rules", "domain", "conjuncts",
+        "disjuncts", "term", "rule_distribution", "default_rule", "missing",
+        "attribute_errors", "class_errors", "attribute_spec", "class_name",
+        "deferred", "seed", "quiet", NULL } ;
+    struct datgen_config config ;
+    struct datgen *generator ;
+    int code ;
+
+    datgen_config_init(&config) ;
+    if (! PyArg_ParseTupleAndKeywords(args, kwds, "|iiii(ff)(ii)(ii)(ff)iffffzzpkp", keywords,
+            &config.relevant, &config.irrelevant, &config.masked, &config.rules,
+            &config.domain[0], &config.domain[1],
+            &config.conjuncts[0], &config.conjuncts[1],
+            &config.disjuncts[0], &config.disjuncts[1],
+            &config.term[0], &config.term[1],
+            &config.rule_distribution, &config.default_rule, &config.missing,
+            &config.attribute_errors, &config.class_errors,
+            &config.attribute_spec, &config.class_name,
+            &config.deferred, &config.seed, &config.quiet))
+        return -1 ;
+
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "Generator is filling buffers") ;
+        return -1 ;
+    }
+
+    /* building uses global state: keep the GIL */
+    code = datgen_open(&config, &generator) ;
+    if (code != DATGEN_OK) {
+        raise_code(code, "Generator") ;
+        return -1 ;
+    }
+    datgen_close(self->generator) ;
+    self->generator = generator ;
+    return 0 ;
+}
+
+
+static void
+Generator_dealloc(Generator *self)
+{
+    datgen_close(self->generator) ;
+    Py_TYPE(self)->tp_free((PyObject *)self) ;
+}
+
+
+static int
+check_open(Generator *self)
+{
+    if (self->generator == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "Generator was not initialized") ;
+        return 0 ;
+    }
+    return 1 ;
+}
+
+
+/*************************************
+** columns(): a (name, type, values, min, max) tuple per column, the
+** visible attributes in order and then the class.
+*************************************/
+static PyObject *
+Generator_columns(Generator *self, PyObject *unused)
+{
+    static const char *types[] = { "", "nominal", "ordinal", "continuous", "class" } ;
+    struct datgen_column info ;
+    PyObject *list, *item ;
+    int c, columns ;
+
+    if (! check_open(self)) return NULL ;
+
+    columns = datgen_columns(self->generator) ;
+    if ((list = PyList_New(columns)) == NULL) return NULL ;
+    for (c = 0; c < columns; c++) {
+        datgen_column(self->generator, c, &info) ;
+        item = Py_BuildValue("(ssldd)", info.name, types[info.type], info.values,
+                             (double)info.min, (double)info.max) ;
+        if (item == NULL) {
+            Py_DECREF(list) ;
+            return NULL ;
+        }
+        PyList_SET_ITEM(list, c, item) ;
+    }
+    return list ;
+}
+
+
+/*************************************
+** label(column, code): the label the text output prints for code.
+*************************************/
+static PyObject *
+Generator_label(Generator *self, PyObject *args)
+{
+    char label[DATGEN_LABEL_MAX] ;
+    int c, code, status ;
+
+    if (! check_open(self)) return NULL ;
+    if (! PyArg_ParseTuple(args, "ii", &c, &code)) return NULL ;
+
+    status = datgen_label(self->generator, c, code, label) ;
+    if (status != DATGEN_OK) return raise_code(status, "label") ;
+    return PyUnicode_FromString(label) ;
+}
+
+
+/*************************************
+** clone(): another Generator on this rule base, at object 0.
+*************************************/
+static PyObject *
+Generator_clone(Generator *self, PyObject *unused)
+{
+    Generator *copy ;
+    int status ;
+
+    if (! check_open(self)) return NULL ;
+    if ((copy = (Generator *)GeneratorType.tp_alloc(&GeneratorType, 0)) == NULL) return NULL ;
+
+    /* shares the rule base: keep the GIL, as datgen_open() does */
+    status = datgen_clone(self->generator, &copy->generator) ;
+    if (status != DATGEN_OK) {
+        Py_DECREF(copy) ;
+        return raise_code(status, "clone") ;
+    }
+    return (PyObject *)copy ;
+}
+
+
+/*************************************
+** seek(object): make object the next one fill() creates.
+*************************************/
+static PyObject *
+Generator_seek(Generator *self, PyObject *args)
+{
+    long object ;
+    int status ;
+
+    if (! check_open(self)) return NULL ;
+    if (! PyArg_ParseTuple(args, "l", &object)) return NULL ;
+
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "Generator is filling buffers") ;
+        return NULL ;
+    }
+    status = datgen_seek(self->generator, object) ;
+    if (status != DATGEN_OK) return raise_code(status, "seek") ;
+    Py_RETURN_NONE ;
+}
+
+
+/*************************************
+** fill(buffers, n): create the next n objects into the buffers.
+*************************************/
+static PyObject *
+Generator_fill(Generator *self, PyObject *args)
+{
+    struct datgen_column info ;
+    PyObject *sequence, *items ;
+    Py_buffer *views ;
+    void **columns ;
+    Py_ssize_t n ;
+    const char *format ;
+    char kind ;
+    int c, count, taken = 0, status ;
+
+    if (! check_open(self)) return NULL ;
+    if (! PyArg_ParseTuple(args, "On", &sequence, &n)) return NULL ;
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "fill: n must not be negative") ;
+        return NULL ;
+    }
+
+    count = datgen_columns(self->generator) ;
+    if ((items = PySequence_Fast(sequence, "fill: buffers must be a sequence")) == NULL)
+        return NULL ;
+    if (PySequence_Fast_GET_SIZE(items) != count) {
+        PyErr_Format(PyExc_ValueError, "fill: %d buffers expected", count) ;
+        Py_DECREF(items) ;
+        return NULL ;
+    }
+
+    views   = (Py_buffer *)PyMem_Calloc(count, sizeof(Py_buffer)) ;
+    columns = (void **)PyMem_Calloc(count, sizeof(void *)) ;
+    if (views == NULL || columns == NULL) {
+        PyErr_NoMemory() ;
+        goto done ;
+    }
+
+    for (c = 0; c < count; c++, taken++) {
+        if (PyObject_GetBuffer(PySequence_Fast_GET_ITEM(items, c), &views[c],
+                               PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0)
+            goto done ;
+
+        datgen_column(self->generator, c, &info) ;
+        format = views[c].format ? views[c].format : "B" ;
+        kind = format[strlen(format) - 1] ;
+        if (views[c].itemsize != 4
+            || (info.type == DATGEN_CONTINUOUS ? kind != 'f' : kind != 'i' && kind != 'l')) {
+            PyErr_Format(PyExc_TypeError, "fill: column %d (%s) needs a %s buffer", c, info.name,
+                         info.type == DATGEN_CONTINUOUS ? "float32" : "int32") ;
+            taken++ ;
+            goto done ;
+        }
+        if (views[c].len < n * 4) {
+            PyErr_Format(PyExc_ValueError, "fill: column %d (%s) has no room for %zd values",
+                         c, info.name, n) ;
+            taken++ ;
+            goto done ;
+        }
+        columns[c] = views[c].buf ;
+    }
+
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "Generator is filling buffers") ;
+        goto done ;
+    }
+    self->busy = 1 ;
+    Py_BEGIN_ALLOW_THREADS
+    status = datgen_fill_batch(self->generator, (long)n, columns) ;
+    Py_END_ALLOW_THREADS
+    self->busy = 0 ;
+
+    if (status != DATGEN_OK) raise_code(status, "fill") ;
+
+done:
+    if (views != NULL)
+        for (c = 0; c < taken; c++) PyBuffer_Release(&views[c]) ;
+    PyMem_Free(views) ;
+    PyMem_Free(columns) ;
+    Py_DECREF(items) ;
+    if (PyErr_Occurred()) return NULL ;
+    Py_RETURN_NONE ;
+}
+
+
+static PyMethodDef Generator_methods[] = {
+    {"columns", (PyCFunction)Generator_columns, METH_NOARGS,
+     "columns() -> [(name, type, values, min, max)], the visible attributes then the class"},
+    {"label", (PyCFunction)Generator_label, METH_VARARGS,
+     "label(column, code) -> the label of code in a nominal column or the class"},
+    {"clone", (PyCFunction)Generator_clone, METH_NOARGS,
+     "clone() -> another Generator on this rule base, for another thread to fill"},
+    {"seek", (PyCFunction)Generator_seek, METH_VARARGS,
+     "seek(object): make object the next one fill() creates"},
+    {"fill", (PyCFunction)Generator_fill, METH_VARARGS,
+     "fill(buffers, n): create the next n objects into one writable buffer per column"},
+    {NULL}
+} ;
+
+static PyTypeObject GeneratorType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "datgen._core.Generator",
+    .tp_doc       = "A DatGen generator built once from the libdatgen config",
+    .tp_basicsize = sizeof(Generator),
+    .tp_flags     = Py_TPFLAGS_DEFAULT,
+    .tp_new       = PyType_GenericNew,
+    .tp_init      = (initproc)Generator_init,
+    .tp_dealloc   = (destructor)Generator_dealloc,
+    .tp_methods   = Generator_methods,
+} ;
+
+static struct PyModuleDef core_module = {
+    PyModuleDef_HEAD_INIT, "datgen._core", "The DatGen C generator", -1, NULL
+} ;
+
+
+PyMODINIT_FUNC
+PyInit__core(void)
+{
+    PyObject *module ;
+
+    if (PyType_Ready(&GeneratorType) < 0) return NULL ;
+    if ((module = PyModule_Create(&core_module)) == NULL) return NULL ;
+
+    ConstrainedError = PyErr_NewException("datgen._core.ConstrainedError", PyExc_ValueError, NULL) ;
+    Py_INCREF(&GeneratorType) ;
+    if (ConstrainedError == NULL
+        || PyModule_AddObject(module, "ConstrainedError", ConstrainedError) < 0
+        || PyModule_AddObject(module, "Generator", (PyObject *)&GeneratorType) < 0) {
+        Py_DECREF(module) ;
+        return NULL ;
+    }
+    Py_INCREF(ConstrainedError) ;
+    return module ;
+}
@@ -1,12 +1,48 @@
 """
 DatGen Classic - Python port of the original C implementation
 This module provides backward compatibility with the 1997 C version
+
+With the datgen._core extension built (python setup.py build_ext --inplace)
+the data comes from the C rule-based generator itself, written straight
+into NumPy arrays; without it, a pure Python approximation is used.
 """
 
 import numpy as np
 import pandas as pd
-from typing import Optional, Union, List
-import string
+from typing import Iterator, Optional, Union, List
+import os
+import warnings
+from concurrent.futures import ThreadPoolExecutor
+
+try:
+    from . import _core
+except ImportError:  # not built: python setup.py build_ext --inplace
+    _core = None
+
+# C: -r 0 deals the rules out in turn, so the classes would strictly
+# alternate; 'uniform' draws each object's rule uniformly, as -r 1 does
+RULE_DISTRIBUTIONS = {'uniform': 1, 'random': 1, 'gaussian': 2}
+
+# Objects a thread of the C generator creates at the least
+OBJECTS_PER_THREAD = 1 << 16
+
+# Rows of a chunk when iterating over DatGenClassic
+DEFAULT_CHUNK_SIZE = 1 << 16
+
+
+def value_label(code: int) -> str:
+    """The C label of nominal code 0, 1, ...: a .. z, aa, ab, ... (num2str)"""
+    label = ''
+    number = code + 1
+    while number > 0:
+        label = chr(ord('a') + (number - 1) % 26) + label
+        number = (number - 1) // 26
+    return label
+
+
+def class_dtype(n_classes: int) -> pd.CategoricalDtype:
+    """The classes c1 .. cN; c0, of the C default rule, is never set here"""
+    return pd.CategoricalDtype([f'c{i}' for i in range(1, n_classes + 1)])
 
 
 class DatGenClassic:
@@ -64,6 +100,15 @@ class DatGenClassic:
         else:
             self.rng = np.random.RandomState()
 
+        # Seed of the C generator (C: -s), drawn once without random_state
+        if random_state is not None:
+            self.seed = int(random_state) & 0xFFFFFFFF
+        else:
+            self.seed = int.from_bytes(os.urandom(4), 'little')
+
+        # C generator config that worked, False when none can
+        self._config = None
+
     def generate(self) -> pd.DataFrame:
         """
         Generate synthetic dataset matching C version output
@@ -71,21 +116,193 @@ class DatGenClassic:
         Returns:
         --------
         pd.DataFrame
-            Generated data with features and class column
+            Generated data with features and class column; categorical
+            features and the class are pandas categoricals of the C labels
         """
+        if self.data_type not in ('categorical', 'continuous'):
+            raise ValueError(f"Unknown data_type: {self.data_type}")
+
+        if _core is not None:
+            df = self._generate_rules()
+            if df is not None:
+                return df
+
         if self.data_type == 'categorical':
             df = self._generate_categorical()
-        elif self.data_type == 'continuous':
+        else:
             df = self._generate_continuous()
+
+        return df
+
+    def _open_generator(self):
+        """Build the C rule base: n_classes rules, one class each
+
+        Every rule tests all of the relevant attributes, so the rules can
+        be kept apart; the remaining features are irrelevant. Start with
+        the fewest relevant attributes whose domains can hold n_classes
+        rules (a continuous attribute splits in two) and add one while the
+        C generator finds the domain too constrained. The config that
+        worked is kept for the next generator.
+
+        Returns None when even all the features cannot keep the rules
+        apart; the data then comes from the Python approximation.
+        """
+        if self._config is False:
+            return None
+        if self._config is not None:
+            return _core.Generator(**self._config)
+
+        base = self.domain_size if self.data_type == 'categorical' else 2
+        relevant = 1
+        while relevant < self.n_features and base ** relevant < self.n_classes:
+            relevant += 1
+
+        for relevant in range(relevant, self.n_features + 1):
+            config = dict(
+                rules=self.n_classes,
+                conjuncts=(relevant - 1, relevant - 1),
+                rule_distribution=RULE_DISTRIBUTIONS.get(self.distribution, 1),
+                attribute_errors=self.noise_level,
+                seed=self.seed,
+                quiet=True,
+            )
+            if self.data_type == 'categorical':
+                config.update(relevant=relevant,
+                              irrelevant=self.n_features - relevant,
+                              domain=(self.domain_size, self.domain_size))
+            else:
+                config.update(attribute_spec=self._attribute_spec(relevant))
+            try:
+                generator = _core.Generator(**config)
+            except _core.ConstrainedError:
+                continue
+            self._config = config
+            return generator
+
+        self._config = False
+        warnings.warn(f"{self.n_classes} classes do not fit rules over {self.n_features} "
+                      f"{self.data_type} features; using the Python approximation")
+        return None
+
+    def _attribute_spec(self, relevant: int) -> str:
+        """The C -X definition of the continuous features"""
+        low, high = self.value_range
+        width = high - low
+        domain = f"{low:g}/{high:g}"
+        term = f"{0.3 * width:g}/{0.7 * width:g}"
+        return ':'.join([f"{domain},{term},C"] * relevant
+                        + [f"{domain},C,I"] * (self.n_features - relevant))
+
+    def _generate_rules(self) -> Optional[pd.DataFrame]:
+        """Generate with the C generator straight into the column arrays"""
+        generators = self._generators(self.n_samples)
+        if generators is None:
+            return None
+        dtypes = self._column_dtypes(generators[0])
+        return self._frame(generators, dtypes, 0, self.n_samples)
+
+    def _generators(self, n: int) -> Optional[list]:
+        """C generators for filling n objects at once, None without rules
+
+        Object i depends only on the seed and i, so large requests are
+        split into slices that threads fill at once (as with C: -j). The
+        rule base is built once; each thread gets a clone of the generator
+        with its own position, and fill() runs without the GIL.
+        """
+        first = self._open_generator()
+        if first is None:
+            return None
+        threads = max(1, min(os.cpu_count() or 1, n // OBJECTS_PER_THREAD))
+        return [first] + [first.clone() for _ in range(threads - 1)]
+
+    def _column_dtypes(self, generator) -> list:
+        """The dtype of each column of a C generator, None for the numeric ones
+
+        The codes index the C labels: columns of the same labels share
+        one categorical dtype. Without a default rule (C: -F) or class
+        errors no object is of class c0, so its category is dropped and
+        _frame() shifts the class codes down by one.
+        """
+        shared = {}
+        dtypes = []
+        for c, (_, kind, values, _, _) in enumerate(generator.columns()):
+            if kind == 'nominal':
+                labels = tuple(generator.label(c, code) for code in range(values))
+                dtypes.append(shared.setdefault(labels, pd.CategoricalDtype(labels)))
+            elif kind == 'class':
+                dtypes.append(class_dtype(values - 1))
+            else:
+                dtypes.append(None)
+        return dtypes
+
+    def _frame(self, generators: list, dtypes: list, first: int, n: int) -> pd.DataFrame:
+        """Objects first .. first+n-1 as a DataFrame indexed by object"""
+        columns = generators[0].columns()
+        arrays = [np.empty(n, np.float32 if kind == 'continuous' else np.int32)
+                  for _, kind, _, _, _ in columns]
+        threads = len(generators)
+
+        def fill(t):
+            begin, end = n * t // threads, n * (t + 1) // threads
+            generators[t].seek(first + begin)
+            generators[t].fill([array[begin:end] for array in arrays], end - begin)
+
+        if threads == 1:
+            fill(0)
         else:
+            with ThreadPoolExecutor(threads) as pool:
+                list(pool.map(fill, range(threads)))
+
+        names = [f'attr{i+1}' for i in range(self.n_features)] + ['class']
+        arrays[-1] -= 1
+        # a missing nominal value (-1) is NaN in the categorical
+        data = {name: array if dtype is None else pd.Categorical.from_codes(array, dtype=dtype)
+                for name, array, dtype in zip(names, arrays, dtypes)}
+        return pd.DataFrame(data, index=pd.RangeIndex(first, first + n), copy=False)
+
+    def generate_chunks(self, chunk_size: int = DEFAULT_CHUNK_SIZE) -> Iterator[pd.DataFrame]:
+        """
+        Generate the dataset chunk_size rows at a time
+
+        The C generator is built once and the rows are created chunk by
+        chunk, so memory stays in proportion to chunk_size. The chunks are
+        indexed by row, and concatenated they equal generate() with the
+        same random_state. The last chunk holds what is left.
+
+        Without the C extension, or without a rule base for the classes,
+        the dataset is generated whole and sliced.
+
+        Yields:
+        -------
+        pd.DataFrame
+            The next chunk_size rows
+        """
+        if chunk_size < 1:
+            raise ValueError(f"chunk_size must be positive: {chunk_size}")
+        if self.data_type not in ('categorical', 'continuous'):
             raise ValueError(f"Unknown data_type: {self.data_type}")
 
-        return df
+        generators = None
+        if _core is not None:
+            generators = self._generators(min(chunk_size, self.n_samples))
+        if generators is None:
+            df = self.generate()
+            for first in range(0, self.n_samples, chunk_size):
+                yield df.iloc[first:first + chunk_size]
+            return
+
+        dtypes = self._column_dtypes(generators[0])
+        for first in range(0, self.n_samples, chunk_size):
+            yield self._frame(generators, dtypes, first, min(chunk_size, self.n_samples - first))
+
+    def __iter__(self) -> Iterator[pd.DataFrame]:
+        """Iterate over the dataset in chunks of DEFAULT_CHUNK_SIZE rows"""
+        return self.generate_chunks()
 
     def _generate_categorical(self) -> pd.DataFrame:
         """Generate categorical data matching C version's Nominal type"""
-        # Domain size determines the letters used (a-j for domain_size=10)
-        letters = list(string.ascii_lowercase[:min(self.domain_size, 26)])
+        # The C labels of the domain (a-j for domain_size=10, then aa, ab, ...)
+        letters = [value_label(code) for code in range(self.domain_size)]
 
         # Generate feature data
         data = []
@@ -112,7 +329,8 @@ class DatGenClassic:
                 col_idx = self.rng.randint(0, self.n_features)
                 df.iloc[row_idx, col_idx] = self.rng.choice(letters)
 
-        return df
+        dtype = pd.CategoricalDtype(letters)
+        return df.astype({name: dtype for name in columns} | {'class': class_dtype(self.n_classes)})
 
     def _generate_continuous(self) -> pd.DataFrame:
         """Generate continuous data matching C version's Continuous type"""
@@ -147,12 +365,12 @@ class DatGenClassic:
                                     size=(self.n_samples, self.n_features))
             df.iloc[:, :self.n_features] = np.where(noise_mask, noise, data)
 
-        return df
+        return df.astype({'class': class_dtype(self.n_classes)})
 
     def _generate_class_labels(self) -> List[str]:
         """Generate class labels matching C version format"""
-        # C version uses 'c0', 'c1', etc.
-        classes = [f'c{i}' for i in range(self.n_classes)]
+        # C version uses 'c1', 'c2', etc.; c0 is its default rule's
+        classes = list(class_dtype(self.n_classes).categories)
 
         # Simple class assignment
         # TODO: Implement C version's rule-based classification
@@ -0,0 +1,43 @@
+"""
+Build the datgen package with its C extension, datgen._core.
+
+The extension links src/libdatgen.a, which build_ext makes first
+(make -C src libdatgen.a). Build in place for the tests with
+
+    python setup.py build_ext --inplace
+
+Without the extension DatGenClassic falls back to pure Python.
+"""
+
+import subprocess
+
+from setuptools import Extension, setup
+from setuptools.command.build_ext import build_ext
+
+
+class BuildWithLibdatgen(build_ext):
+    """Make the static C library before linking the extension against it"""
+
+    def run(self):
+        subprocess.check_call(['make', '-C', 'src', 'libdatgen.a'])
+        super().run()
+
+
+setup(
+    name='datgen',
+    version='4.0.0',
+    description='DatGen - Synthetic Data Generator',
+    packages=['datgen'],
+    install_requires=['numpy', 'pandas'],
+    ext_modules=[
+        Extension(
+            'datgen._core',
+            sources=['datgen/_core.c'],
+            include_dirs=['src'],
+            extra_objects=['src/libdatgen.a'],
+            libraries=['m', 'pthread', 'z'],
+            depends=['src/datgen.h', 'src/datgen.c'],
+        )
+    ],
+    cmdclass={'build_ext': BuildWithLibdatgen},
+)
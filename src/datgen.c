@@ -1,6 +1,6 @@
 
-#define	DATE       "2000/02/21"
-#define	VERSION    "3.1.1"
+#define	DATE       "2026/10/17"
+#define	VERSION    "3.2"
 #define	SUPPORT    "support@datasetgenerator.com"
 
 /*****************************************************************
@@ -27,6 +27,45 @@
 **                                                              **
 ** NEW                                                          **
 **                                                              **
+** In 3.2                                                       **
+**  - Counter-based random streams -k (object i depends only    **
+**    on the seed and i) and an explicit seed -s                **
+**  - Objects created by -j parallel threads, output in order   **
+**  - Objects validated with a bitset index of the rule base    **
+**  - New rules tested only against the rules they overlap      **
+**  - Nominal term values also kept as a bitset                 **
+**  - Objects created from a flat array copy of the rule base   **
+**  - -l draws the attributes no rule tests only once an object **
+**    has been accepted                                         **
+**  - Objects formatted into large buffers without printf and   **
+**    written with write(); the text is unchanged               **
+**  - Nominal labels rendered once into a table; num2str() is   **
+**    now right past zzzzz                                      **
+**  - -t arrow|arrows writes an Arrow IPC file or stream, one   **
+**    record batch per chunk of objects                         **
+**  - -t parquet writes a Parquet file, one row group per chunk **
+**  - -t npy -o dir writes a NumPy .npy file per column,        **
+**    filled in place by the threads, and a datgen.json sidecar **
+**  - -Z gzip compresses each chunk on its thread into its own  **
+**    gzip member                                               **
+**  - -o writes to a preallocated file; threads pwrite() their  **
+**    chunks side by side                                       **
+**  - -S splits the output into part files and a manifest       **
+**  - -t libsvm and -t arff write sparse rows                   **
+**  - -t rows -o file writes fixed size binary records, each    **
+**    at its own offset, described in a FILE.json sidecar       **
+**  - -O inf and -O Ns stream objects until stopped, -L caps    **
+**    the rows or MB per second; SIGUSR1 rewrites the -f report **
+**  - -i start:end creates only those objects of the data set,  **
+**    without the ones before them                              **
+**  - libdatgen (make libdatgen.a, datgen.h) fills the caller's **
+**    column buffers; errors come back as the exit codes        **
+**  - -q leaves a too constrained domain to the exit code 1     **
+**  - -U path serves named, prebuilt generators over a Unix     **
+**    socket: rows [a,b) of generator G in format F             **
+**  - No compile-time limit on the number of attributes, named  **
+**    A..Z, AA..ZZ, AAA.. as spreadsheet columns                **
+**                                                              **
 ** In 3.1                                                       **
 **  - Introduced continuous datatype                            **
 **  - Onesided numerical tests. T(wosided) is now an -X option  **
@@ -77,6 +116,7 @@
 ** GLOBAL VARIABLES                                             **
 ** FORWARD DECLARATION                                          **
 ** MAIN                                                         **
+** datgen_main()                                                **
 **  - PROCESS THE PROGRAM'S PARAMETERS                          **
 **  - INITIALIZE RANDOMNESS                                     **
 **  - CREATE THE DATA DICTIONARY                                **
@@ -91,12 +131,106 @@
 **  - CREATE THE OBJECTS                                        **
 **  - Display Rules (when verbose)                              **
 **                                                              **
+** LIBRARY PROCEDURES                                           **
+** datgen_config_init()                                         **
+** datgen_open()                                                **
+** datgen_clone()                                               **
+** datgen_column()                                              **
+** datgen_label()                                               **
+** datgen_seek()                                                **
+** datgen_fill_batch()                                          **
+** datgen_close()                                               **
+** build_datgen()                                               **
+** new_datgen()                                                 **
+** free_build()                                                 **
+** free_generator()                                             **
+** free_rules()                                                 **
+**                                                              **
+** SERVER PROCEDURES                                            **
+** serve()                                                      **
+** serve_request()                                              **
+** send_rows()                                                  **
+**                                                              **
+** RULE INDEX PROCEDURES                                        **
+** new_overlap_index()                                          **
+** free_overlap_index()                                         **
+** overlap_conflict()                                           **
+** overlap_insert()                                             **
+** interval_insert()                                            **
+** interval_stab()                                              **
+** flatten_rules()                                              **
+** build_match_index()                                          **
+** rule_term()                                                  **
+** match_set()                                                  **
+** match_conflict()                                             **
+**                                                              **
+** OBJECT PROCEDURES                                            **
+** create_object()                                              **
+** draw_value()                                                 **
+** add_noise()                                                  **
+** format_object()                                              **
+** format_banner()                                              **
+** format_sparse()                                              **
+** format_arff_header()                                         **
+** object_worker()                                              **
+** create_objects()                                             **
+** create_parts()                                               **
+** remove_parts()                                               **
+** report_rules()                                               **
+** dump_rules()                                                 **
+** count_rules()                                                **
+** take_tokens()                                                **
+** clock_seconds()                                              **
+** on_signal()                                                  **
+** out_printf()                                                 **
+** out_text()                                                   **
+** out_int()                                                    **
+** out_float()                                                  **
+** out_write()                                                  **
+** out_pwrite()                                                 **
+** out_allocate()                                               **
+** out_compress()                                               **
+**                                                              **
+** OUTPUT FORMAT PROCEDURES                                     **
+** format_named()                                               **
+** arrow_index_width()                                          **
+** arrow_message_begin()                                        **
+** arrow_message_end()                                          **
+** arrow_record_batch_meta()                                    **
+** arrow_schema()                                               **
+** arrow_dictionary()                                           **
+** arrow_record_batch()                                         **
+** arrow_begin()                                                **
+** arrow_end()                                                  **
+** add_block()                                                  **
+** rle_hybrid()                                                 **
+** parquet_page_header()                                        **
+** parquet_row_group()                                          **
+** parquet_end()                                                **
+** npy_column()                                                 **
+** npy_begin()                                                  **
+** npy_chunk()                                                  **
+** npy_end()                                                    **
+** rows_field()                                                 **
+** rows_begin()                                                 **
+** rows_chunk()                                                 **
+**                                                              **
 ** SUPPORT PROCEDURES                                           **
+** fail()                                                       **
 ** compare_rule_freq()                                          **
 ** compare_int()                                                **
+** bit_count()                                                  **
+** sets_overlap()                                               **
+** num2str()                                                    **
+** build_labels()                                               **
 ** n_rand()                                                     **
 ** int_rand()                                                   **
 ** sn_rand()                                                    **
+** rand_seek()                                                  **
+** rand_block()                                                 **
+** n_rand_r()                                                   **
+** int_rand_r()                                                 **
+** sn_rand_r()                                                  **
 *****************************************************************/
 
 
@@ -115,6 +249,26 @@
 #include 	<string.h>	/* strtok() */
 #include	<time.h>	/* time() */
 #include	<stdlib.h>  /* qsort(), calloc() on macOS/BSD */
+#include	<stdarg.h>	/* va_list for out_printf() */
+#include	<limits.h>	/* CHAR_BIT */
+#include	<pthread.h>	/* -j worker threads */
+#include	<unistd.h>	/* write() */
+#include	<errno.h>	/* EINTR */
+#include	<fcntl.h>	/* open() */
+#include	<sys/types.h>	/* off_t */
+#include	<sys/stat.h>	/* mkdir() */
+#include	<zlib.h>	/* -Z gzip */
+#include	<signal.h>	/* -O inf: SIGINT, SIGPIPE, SIGUSR1 */
+#include	<sys/time.h>	/* gettimeofday() */
+#include	<setjmp.h>	/* fail() inside libdatgen */
+#include	<sys/socket.h>	/* -U: socket() */
+#include	<sys/un.h>	/* -U: struct sockaddr_un */
+#include	<dirent.h>	/* -S: opendir() */
+
+#ifndef S_ISSOCK	/* hidden by -ansi */
+#define	S_ISSOCK(mode)        (((mode) & 0170000) == 0140000)
+#endif
+#include	"datgen.h"	/* libdatgen */
 
 
 /*****************************************************************
@@ -122,16 +276,35 @@
 ** DEFINED DEFAULTS                                             **
 ******************************************************************
 *****************************************************************/
-#define	MAX_ATTRIBUTES        256	/* plenty of dimensions */
 #define	FAILURES_PER_RULE     20	/* heuristic from tests */
 #define	FAILURES_PER_OBJECT   12	/* heuristic from tests */
+#define	OBJECTS_PER_CHUNK     65536	/* objects handed to a thread at once */
+#define	FIELDS_PER_CHUNK      1048576L	/* ... fewer when the rows are wide */
+#define	OUT_FIELD_MAX         512	/* longest text of one out_printf() */
+#define	REQUEST_MAX           65536	/* -U: longest request line */
+#define	REQUEST_WORDS         4096	/* -U: words of a request */
+#define	WORD_BITS             (CHAR_BIT*(int)sizeof(unsigned long)) /* bitset words */
+#define	SET_WORDS(dom_max)    ((int)(dom_max)/WORD_BITS + 1)	/* words for values 0..dom_max */
+#define	SET_HOLDS(set, v)     (((set)[(v)/WORD_BITS] >> ((v)%WORD_BITS)) & 1UL)
+#define	PAD8(n)               (((n) + 7) & ~7L)	/* Arrow buffers are 8-byte aligned */
 
 #define	CLASS_NAME            "Class" /* default class name */
 
 #define	DEBUG                 1
 #define	PSEUDORANDOM          1
+#define	COUNTERRANDOM         1
 #define	VERBOSE               1
 
+#define	OUT_TSV               0	/* -t: tab separated text */
+#define	OUT_ARROW             1	/* Arrow IPC file */
+#define	OUT_ARROW_STREAM      2	/* Arrow IPC stream */
+#define	OUT_PARQUET           3	/* Parquet file */
+#define	OUT_NPY               4	/* a NumPy .npy file per column */
+#define	OUT_LIBSVM            5	/* sparse text: class index:value ... */
+#define	OUT_ARFF              6	/* sparse ARFF: {index value, ...} */
+#define	OUT_ROWS              7	/* fixed size binary records */
+#define	TEXT_FORMAT(format)   ((format) == OUT_TSV || (format) == OUT_LIBSVM || (format) == OUT_ARFF)
+
 #define	UNIFORM_DISTRIBUTION  0
 #define	RANDOM_DISTRIBUTION   1
 #define	NORMAL_DISTRIBUTION   2
@@ -156,6 +329,13 @@
 #define MISSINGVAL            88888888
 #define MISSINGVALCHAR        "?"
 
+/* Philox4x32-10 counter-based generator constants (Salmon et al. 2011) */
+#define PHILOX_M0             0xD2511F53UL
+#define PHILOX_M1             0xCD9E8D57UL
+#define PHILOX_W0             0x9E3779B9UL
+#define PHILOX_W1             0xBB67AE85UL
+#define PHILOX_ROUNDS         10
+
 
 
 
@@ -166,23 +346,35 @@
 *****************************************************************/
 #define  USAGE \
 fprintf(stderr, "\nVersion %s\t%s\t%s\n", VERSION, SUPPORT, DATE) ; \
-fprintf(stderr, "\nSYNTAX: %s [-hvpc] [-AefgIMmPRrO value] [-DCTd value[,value]] [-X string]\n\n", program_name) ; \
+fprintf(stderr, "\nSYNTAX: %s [-hvpklcq] [-AefgIijLMmPRrOoSstUZ value] [-DCTd value[,value]] [-X string]\n\n", program_name) ; \
 fprintf(stderr, "\tmore @ www.datasetgenerator.com/parameters.html\n") ; \
 fprintf(stderr, "\th:\thelp (this report) [default value]\n") ; \
 fprintf(stderr, "\tv:\tverbose report [false]\n")	; \
 fprintf(stderr, "\tp:\tpseudo randomness [false]\n")	; \
+fprintf(stderr, "\tk:\tcounter-based randomness, object i depends only on seed and i [false]\n")	; \
+fprintf(stderr, "\tl:\tdraw the attributes no rule tests after an object is accepted [false]\n")	; \
 fprintf(stderr, "\tc:\tplain column banner [false]\n")	; \
+fprintf(stderr, "\tq:\tquiet: a too constrained domain only sets exit code 1 [false]\n")	; \
 fprintf(stderr, "\n") ; \
 fprintf(stderr, "\te:\tProportion of erroneously entered attribute-values\n") ; \
 fprintf(stderr, "\tf:\tFile path to hold rules [stdout]\n") ; \
 fprintf(stderr, "\tF:\tDefault rule ratio: 1.0 to 100.0%% or 0.0 to 0.99.\n") ; \
 fprintf(stderr, "\tg:\tProportion of erroneously entered class-values\n") ; \
+fprintf(stderr, "\ti:\tCreate only objects start to end-1, given as start:end (implies -k)\n") ; \
+fprintf(stderr, "\tj:\tNumber of threads creating objects (implies -k) [1]\n") ; \
+fprintf(stderr, "\tL:\tRate limit in objects per second, or NMB for megabytes per second [none]\n") ; \
 fprintf(stderr, "\tM:\tNumber of masked relevant attributes\n") ; \
 fprintf(stderr, "\tm:\tProportion of missing attribute-values\n") ; \
 fprintf(stderr, "\tP:\tName of predicted attribute [%s]\n", class_name ) ; \
 fprintf(stderr, "\tR:\tNumber of DNF rules\n")	; \
 fprintf(stderr, "\tr:\tRule distribution 0=uniform,1=random,2=standard normal [1]\n") ; \
-fprintf(stderr, "\tO:\tNumber of objects\n") ; \
+fprintf(stderr, "\tO:\tNumber of objects, inf, or Ns to stream for N seconds\n") ; \
+fprintf(stderr, "\tS:\tSplit into -o directory files of value objects, or value parts (e.g. 8p)\n") ; \
+fprintf(stderr, "\ts:\tRandom seed (implies -p)\n") ; \
+fprintf(stderr, "\tt:\tOutput format: tsv, arrow (IPC file), arrows (IPC stream), parquet, npy,\n\t\tlibsvm, arff (sparse), rows (fixed size binary records) [tsv]\n") ; \
+fprintf(stderr, "\to:\tOutput file, a directory for -t npy [stdout]\n") ; \
+fprintf(stderr, "\tU:\tServe generators over this Unix socket: open NAME OPTION ...,\n\t\trows NAME START END [FORMAT [PATH]], close NAME, quit [none]\n") ; \
+fprintf(stderr, "\tZ:\tCompress the text output: gzip or gzip:level (1-9) [none]\n") ; \
 fprintf(stderr, "\n") ; \
 fprintf(stderr, "\tRanges (min,max)\n") ; \
 fprintf(stderr, "\tD:\tDisjunctions per rule\n") ; \
@@ -227,9 +419,9 @@ fprintf(stderr, "\n") ;
 *********************************************************************/
 
 
-typedef float	object[MAX_ATTRIBUTES] ;
-	/* A Fully Conj. Rule definition can't be */
-	/* greater in size than the attribute_map */
+typedef float	*object ;
+	/* One row of attribute-values, allocated */
+	/* for the number of attributes           */
 
 
 /***************************************
@@ -237,7 +429,7 @@ typedef float	object[MAX_ATTRIBUTES] ;
 ***************************************/
 
 struct Attribute_def {
-  char   name[3]  ;   /* Attribute's given name.                             */
+  char   *name  ;     /* Attribute's given name: A..Z, AA..ZZ, AAA...         */
   char   datatype ;   /* Nominal, ordinal ,or continuous attribute.          */
   float  dom_min  ;   /* Min num associated with this attr. = 1 if NOMINAL  */
   float  dom_max  ;   /* Max num associated with this attr  >= 1 if NOMINAL  */
@@ -262,6 +454,7 @@ struct Terms {
   int    attribute ;     /* keep memory of referenced attribute */
   int    setsize  ;      /* number of values-1 in the set for this term <= attribute domain */
   int    *nominal ;      /* values for terms over a nominal attribute */
+  unsigned long *members ; /* the same values as a bitset, bit v for value v */
   float  interval ;
   int    ordinal[2] ;    /* min/max */
   float  continuous[2] ; /* min/max */
@@ -275,16 +468,266 @@ struct Terms {
 struct CNF_Rule {
   /* This structure contains a single CNF Rule */
   int    conjuncts ;	/* number of terms selected for this rule */
-  int    attribute_map[MAX_ATTRIBUTES] ; /* bit map of attrs used by this rule */
-  int    objects ;	/* number of objects instantiated using this rule */
+  long   objects ;	/* number of objects instantiated using this rule */
   int    tail ;		/* class selected for this rule */
   int    default_rule ;	/* is this the default rule */
-  struct Terms	*body ;	/* compact CNF description */
+  struct Terms	*body ;	/* compact CNF description, in attribute order */
 
 } *Rules ;
 
 
 
+/**************************************
+** Labels of the nominal values.     **
+**************************************/
+
+struct Label_table {
+  /* Value v prints as LABEL(v), for v in 1 .. values */
+  int    values ;	/* largest nominal domain */
+  char   *text ;	/* all the labels, each ending with a 0 */
+  long   *start ;	/* value v's label is text[start[v]] .. text[start[v+1]-2] */
+} Labels ;
+
+#define	LABEL(v)          (Labels.text + Labels.start[v])
+#define	LABEL_LENGTH(v)   ((int)(Labels.start[(v)+1] - Labels.start[v]) - 1)
+
+
+
+/*******************************************
+** Structures for the random streams.     **
+*******************************************/
+
+struct Rand_stream {
+  /* In counter mode each object owns a stream positioned at (object, retry) */
+  /* so its values do not depend on how many draws preceded it.              */
+  int            counter ;   /* drand48() sequence (0) or Philox counter (1) */
+  unsigned long  key[2] ;    /* 64-bit seed as two 32-bit words              */
+  unsigned long  ctr[4] ;    /* block, retry, object index low and high word */
+  unsigned long  block[4] ;  /* most recent Philox output                    */
+  int            used ;      /* words of block already consumed              */
+} ;
+
+
+
+/***********************************************************
+** Structures to index the rules by their attribute-values **
+***********************************************************/
+
+struct Flat_rules {
+  /* The finished rule base as parallel arrays of terms, so the object */
+  /* loop reads a rule's own terms sequentially instead of a list.     */
+  int    rules ;	/* cnf_rules; rule 0 is the default rule */
+  int    terms ;
+  int    *first ;	/* rule n's terms are first[n] .. first[n+1]-1 */
+  int    *rule ;	/* rule of each term */
+  int    *attribute ;	/* attribute of each term, increasing within a rule */
+  char   *datatype ;
+  float  *low ;		/* ORDINAL, CONTINUOUS: interval */
+  float  *high ;
+  int    *set_first ;	/* NOMINAL: the term's values start at values[set_first] */
+  int    *set_size ;
+  int    *values ;	/* sorted values of all nominal terms */
+} ;
+
+
+struct Attribute_index {
+  /* One bitset of rules per nominal value or per interval region. Rules   */
+  /* without a term on the attribute accept every value so are in all sets. */
+  int    attribute ;	/* attribute number in the data dictionary */
+  char   datatype ;
+  int    values ;	/* NOMINAL: domain size. Otherwise: interval end points */
+  float  *points ;	/* sorted distinct end points of the rules' intervals */
+  unsigned long	*accept ;	/* NOMINAL: set 0 holds values outside the  */
+				/* domain, set v holds value v.              */
+				/* Otherwise: region 2p+1 is points[p] and   */
+				/* region 2p lies between points[p-1] and [p] */
+} ;
+
+
+struct Interval_node {
+  /* Node of an interval tree (a treap ordered by low end point) */
+  float  low ;
+  float  high ;
+  float  max ;		/* highest end point in this subtree */
+  int    rule ;
+  unsigned long	priority ;	/* heap order keeps the tree balanced */
+  struct Interval_node *left, *right ;
+} ;
+
+
+struct Overlap_index {
+  /* The committed rules by the regions their terms cover, per attribute */
+  struct Attribute_def	*dictionary ;
+  int    attributes ;
+  int    words ;		/* unsigned longs per bitset of rules */
+  int    nodes ;		/* interval nodes created so far */
+  unsigned long	*committed ;	/* rules accepted so far */
+  unsigned long	*hits ;		/* scratch: rules overlapping a term */
+  unsigned long	*candidates ;	/* scratch: rules overlapping so far */
+  unsigned long	**referencing ;	/* committed rules with a term on attribute */
+  unsigned long	**postings ;	/* NOMINAL: rules holding each value 1..dom_max */
+  struct Interval_node **tree ;	/* ORDINAL, CONTINUOUS: the rules' intervals */
+} ;
+
+
+struct Match_index {
+  /* Rules that could have created an object = AND of its attribute sets */
+  int    words ;	/* unsigned longs per bitset of cnf_rules+1 rules */
+  int    used ;		/* attributes referenced by at least one rule */
+  unsigned long	*all ;	/* the rule base less the default rule */
+  struct Attribute_index *entry ;
+} ;
+
+
+
+/************************************************
+** Structures to create and output the objects **
+************************************************/
+
+struct Generator {
+  /* Settings the object loop needs once the rule base exists */
+  struct Attribute_def	*dictionary ;
+  int    attributes ;
+  int    classes ;
+  int    cnf_rules ;
+  long   objects ;
+  int    rule_distr ;
+  float  default_rule ;
+  float  miss_ratio ;
+  float  attrib_error ;
+  float  class_error ;
+  int    deferred ;	/* -l: draw untested attributes after validation */
+  int    quiet ;	/* -q: no report of a too constrained domain */
+  int    format ;	/* -t: OUT_TSV, OUT_ARROW, ... */
+  char   *path ;	/* -o: where the output goes, NULL for stdout */
+  int    compress ;	/* -Z: gzip level of each chunk, 0 for none */
+  int    banner ;	/* -c: the attribute names head the text output */
+  long   first ;	/* index of the first object of this run */
+  int    endless ;	/* -O inf or -O Ns: create objects until stopped */
+  double seconds ;	/* -O Ns: stop after this long, 0 for never */
+  double rate ;		/* -L: objects, or bytes, per second; 0 for no limit */
+  int    rate_bytes ;	/* -L NMB: rate counts bytes */
+  FILE   *rule_fd ;	/* -f: rewritten on SIGUSR1 */
+  int    *columns ;	/* OUT_NPY: file of each column, OUT_ROWS: its offset
+			   in the record; -1 if masked */
+  long   column_start ;	/* OUT_NPY: bytes of each file's header */
+  long   record ;	/* OUT_ROWS: bytes of each object */
+  struct Rand_stream	stream ;	/* copied by every worker */
+  struct CNF_Rule	*rules ;	/* the rule base: tails, bodies, counts */
+  struct Flat_rules	*flat ;		/* the rule base as arrays of terms */
+  struct Match_index	*index ;	/* rules accepting each attribute-value */
+} ;
+
+
+struct Out_buffer {
+  char   *text ;	/* formatted objects waiting to be written */
+  long   length ;	/* characters used */
+  long   size ;		/* characters allocated */
+} ;
+
+
+struct Batch {
+  /* The objects of a chunk kept for a binary output format */
+  long   rows ;
+  float  *values ;	/* rows x attributes, one object after the other */
+  int    *class ;
+  int    *codes ;	/* scratch: one column's levels or indices */
+} ;
+
+
+struct Fb_table {
+  /* A FlatBuffers table being written */
+  long   start ;	/* position of its vtable offset */
+  int    fields ;
+  int    slot[8] ;	/* offset of each field from start, 0 when absent */
+} ;
+
+
+struct Block_list {
+  /* Parts of a binary file for its footer: offset and two lengths */
+  long   blocks ;
+  long   size ;
+  long   *block ;
+} ;
+
+
+struct Chunk_queue {
+  /* Hands out chunks of objects and orders their output */
+  pthread_mutex_t	lock ;
+  pthread_cond_t	turn ;
+  long   per_chunk ;	/* objects in a chunk */
+  long   chunks ;	/* number of chunks in the run */
+  long   next_chunk ;	/* next chunk to be created */
+  long   next_write ;	/* next chunk to be written */
+  long   written ;	/* bytes written, or placed with -o, so far */
+  long   allocated ;	/* -o: bytes preallocated in the file */
+  double start ;	/* seconds on the clock at the start of the run */
+  double tokens ;	/* -L: token bucket, may go negative */
+  double refilled ;	/* -L: when the bucket was last filled up */
+  long   failures ;	/* objects rejected by all the workers so far */
+  int    caught ;	/* fail() in a worker comes back to create_objects() */
+  int    failed ;	/* exit code of the first worker that failed, or 0 */
+  struct Block_list	dictionaries ;
+  struct Block_list	batches ;
+} ;
+
+
+struct Worker {
+  struct Generator	*gen ;
+  struct Chunk_queue	*queue ;
+  struct Rand_stream	stream ;	/* private copy of gen->stream */
+  struct Out_buffer	out ;		/* the current chunk's text */
+  struct Batch		batch ;		/* the current chunk's objects (-t) */
+  struct Out_buffer	fb ;		/* scratch for message metadata, pages */
+  struct Out_buffer	packed ;	/* scratch for -Z */
+  struct Block_list	columns ;	/* column chunks of the current row group */
+  int    *rule_objects ;	/* objects created by each rule */
+  long   failures ;		/* objects rejected, when there is no queue */
+  unsigned long	**match_sets ;	/* match index bitsets of the current object */
+  pthread_t	thread ;
+} ;
+
+
+struct datgen {
+  /* A libdatgen generator: a rule base and the one worker running it */
+  struct Generator	gen ;
+  struct Worker		worker ;
+  int    *users ;	/* generators sharing the rule base, see datgen_clone() */
+  char   class_name[40] ;
+  int    columns ;	/* visible attributes and the class */
+  int    *attribute ;	/* attribute of each column, attributes for the class */
+  long   next ;		/* object the next batch starts with */
+  object new_object ;
+  char   *erroneous ;	/* flag per attribute */
+} ;
+
+
+struct Build {
+  /* What datgen_main() has allocated so far for a generator it builds,
+     given back by free_build() when fail() ends the build early */
+  char   *expression ;	/* -X and its tokens */
+  char   **xtokens ;
+  struct Attribute_def *dictionary ;
+  int    attributes ;
+  int    *relevant ;
+  struct CNF_Rule *rules ;
+  int    cnf_rules ;
+  struct Terms *body ;	/* the rule being drawn, not yet in rules */
+  int    *term_attribute ;
+  char   *taken ;
+  struct Overlap_index *overlap ;
+  FILE   *rule_fd ;
+} ;
+
+
+struct Served {
+  /* -U: a generator kept by the server under its name */
+  char   name[64] ;
+  struct datgen		*generator ;
+  struct Served		*next ;
+} ;
+
+
 
 /*********************************************************************
 **********************************************************************
@@ -295,6 +738,12 @@ int   debug    = ! DEBUG ;   /* display progress information */
 int   verbose  = ! VERBOSE ; /* report supplementary information */
 char  program_name[40] ;     /* kept for friendly syntax report */
 char  class_name[40] ;       /* Customized class name */
+int   output_fd = 1 ;        /* out_write() destination, -o opens a file */
+volatile sig_atomic_t stop_requested   = 0 ;	/* SIGINT, SIGTERM, closed pipe */
+volatile sig_atomic_t report_requested = 0 ;	/* SIGUSR1 */
+pthread_key_t  failure_key ;	/* libdatgen: the jmp_buf of fail() in this thread */
+pthread_once_t failure_once = PTHREAD_ONCE_INIT ;
+int   failure_keyed = 0 ;
 
 
 
@@ -304,18 +753,107 @@ char  class_name[40] ;       /* Customized class name */
 **********************************************************************
 *********************************************************************/
 
+int     datgen_main(int argc, char *argv[], struct Generator *built, struct Build *partial) ;
+int     build_datgen(int argc, char *argv[], struct datgen **generator) ;
+struct datgen *new_datgen(struct Generator *gen) ;
+void    free_build() ;
+void    free_generator() ;
+void    free_rules() ;
+int     serve(char *path, int jobs) ;
+int     serve_request(int client, struct Served **served, int jobs) ;
+void    send_rows(int client, int fd) ;
+void    fail() ;
+void    failure_key_create() ;
 int     compare_rule_freq() ;
+void    report_rules(struct Generator *gen, FILE *stream) ;
+void    dump_rules() ;
+void    count_rules() ;
+void    take_tokens(struct Chunk_queue *q, double rate, double units) ;
+double  clock_seconds() ;
+void    on_signal() ;
 int     compare_int() ;
+int     compare_float() ;
+int     bit_count() ;
+int     sets_overlap() ;
 double  n_rand() ;
 int     int_rand() ;
 float   flt_rand() ;
 double  sn_rand() ;
 int     num2str() ;
+void    build_labels() ;
+void    rand_seek() ;
+struct Overlap_index *new_overlap_index() ;
+void    free_overlap_index() ;
+int     overlap_conflict() ;
+void    overlap_insert() ;
+struct Interval_node *interval_insert() ;
+void    interval_stab(struct Interval_node *t, float x, unsigned long *hits) ;
+struct Flat_rules *flatten_rules() ;
+struct Match_index *build_match_index() ;
+struct Terms *rule_term() ;
+unsigned long *match_set(struct Attribute_index *ai, float value, int words) ;
+int     match_conflict() ;
+int     create_object() ;
+void    draw_value() ;
+int     add_noise() ;
+void    format_object() ;
+void    format_banner() ;
+void    format_sparse() ;
+void    format_arff_header() ;
+void    *object_worker() ;
+void    create_objects() ;
+void    create_parts() ;
+void    remove_parts() ;
+void    out_printf(struct Out_buffer *ob, char *format, ...) ;
+void    out_text(struct Out_buffer *ob, char *text, int length, char end) ;
+void    out_int(struct Out_buffer *ob, long value, char end) ;
+void    out_float(struct Out_buffer *ob, float value, char end) ;
+void    out_write() ;
+void    out_pwrite(struct Out_buffer *ob, long offset) ;
+void    out_allocate(struct Chunk_queue *q, long chunk) ;
+void    out_compress(struct Out_buffer *ob, struct Out_buffer *packed, int level) ;
+int     arrow_index_width(long values) ;
+long    arrow_message_begin(struct Out_buffer *fb, int header_type, long body_length) ;
+int     arrow_message_end(struct Out_buffer *fb, struct Out_buffer *ob) ;
+void    arrow_record_batch_meta(struct Out_buffer *fb, long at, long rows,
+		int nodes, long *node, int buffers, long *buffer) ;
+void    arrow_schema() ;
+void    arrow_dictionary(struct Generator *gen, int k, struct Out_buffer *fb,
+		struct Out_buffer *ob, int *meta_length, long *body_length) ;
+void    arrow_record_batch(struct Generator *gen, struct Batch *batch,
+		struct Out_buffer *fb, struct Out_buffer *ob, int *meta_length, long *body_length) ;
+void    arrow_begin() ;
+void    arrow_end() ;
+void    rle_hybrid(struct Out_buffer *ob, int *codes, long n, int width) ;
+void    parquet_page_header(struct Out_buffer *ob, int dictionary, long values,
+		int encoding, long length) ;
+void    parquet_row_group(struct Generator *gen, struct Batch *batch,
+		struct Out_buffer *page, struct Out_buffer *ob, struct Block_list *columns) ;
+void    parquet_end() ;
+long    npy_column() ;
+void    npy_begin() ;
+void    npy_chunk(struct Generator *gen, struct Batch *batch, long first, struct Out_buffer *ob) ;
+void    npy_end() ;
+int     format_named(char *name) ;
+int     rows_field() ;
+void    rows_begin() ;
+void    rows_chunk(struct Generator *gen, struct Batch *batch, long first, struct Out_buffer *ob) ;
+void    add_block(struct Block_list *list, long offset, int meta_length, long body_length) ;
+void    rand_block() ;
+double  n_rand_r() ;
+int     int_rand_r() ;
+double  sn_rand_r() ;
 
 extern double   drand48() ;
 extern double   pow() ;
 extern int      getopt(int argc, char **argv, char *optstring);
 extern void     srand48(long seedval);
+extern ssize_t  pwrite(int fd, const void *buf, size_t count, off_t offset);
+extern int      ftruncate(int fd, off_t length);
+extern int      fileno(FILE *stream);
+#ifdef __linux__
+extern int      posix_fallocate(int fd, off_t offset, off_t length);
+#endif
 
  
 
@@ -325,15 +863,35 @@ extern void     srand48(long seedval);
 ******************************************************************
 *****************************************************************/
 
+#ifndef LIBDATGEN
 int main(int argc, char *argv[])
 {
+   return(datgen_main(argc, argv, NULL, NULL)) ;
+}
+#endif
+
+
+/*****************************************************************************
+** datgen_main()
+**
+** The datgen program. With built it stops once the rule base is ready and
+** hands the generator over instead of creating the objects: datgen_open()
+** builds its generators this way, from the options of its config. What it
+** has allocated on the way is kept in partial for a failed build.
+*****************************************************************************/
+int datgen_main(int argc, char *argv[], struct Generator *built, struct Build *partial)
+{
+    struct Build	unkept ;
+    struct Build	*keep = partial ? partial : &unkept ;
 
     struct Attribute_def *Data_Dictionary=0 ;	/* Table information */
 
     char	rule_file[256] ;	/* file name for rule deposit */
     FILE	*rule_fd=NULL ;		/* rule file handle */
-    int     i, j=0, k, l, m, n ;	/* for loop indeces */
-    int     Relevant[MAX_ATTRIBUTES] ;		
+    int     i, j=0, k, l ;	/* for loop indeces */
+    int     *Relevant=NULL ;	/* flag per attribute */
+    int     *term_attribute ;	/* attributes of the rule being created */
+    char    *taken ;		/* flag per attribute: in that rule */
     int     attributes=0 ;		/* Total number of pred. attribs */
 
     float   attrib_error     = 0.0 ;
@@ -353,9 +911,30 @@ int main(int argc, char *argv[])
     int     masked           = 0 ;
     float   miss_ratio       = 0.0 ;	/* from 0.0 to 1.0 */
     int     random_style     = ! PSEUDORANDOM ;
+    int     counter_style    = ! COUNTERRANDOM ;
+    unsigned long seed       = 0 ;	/* key of the counter-based streams */
+    int     seeded           = 0 ;	/* flag: -s was given */
+    int     jobs             = 1 ;	/* threads creating objects */
+    int     deferred         = 0 ;	/* flag: -l */
+    int     quiet            = 0 ;	/* flag: -q */
+    int     format           = OUT_TSV ;	/* -t */
+    char    *output_path     = NULL ;	/* -o */
+    char    *server_path     = NULL ;	/* -U */
+    int     compress         = 0 ;	/* -Z: gzip level */
+    long    split            = 0 ;	/* -S: objects per part */
+    char    split_unit       = 0 ;	/* -S: 'p' when split is a number of parts */
+    struct Generator generator ;	/* what the object loop needs */
+    struct Overlap_index *overlap ;	/* committed rules by attribute region */
     int     relevant         = 0 ;
-    int     objects          = 0 ;
-    int     object_failures  = 0 ;	/* Retrials counter */
+    long    objects          = 0 ;
+    int     endless          = 0 ;	/* -O inf or -O Ns */
+    long    range_start      = 0 ;	/* -i: first object */
+    long    range_end        = -1 ;	/* -i: object after the last, -1 without -i */
+    double  seconds          = 0 ;	/* -O Ns */
+    double  rate             = 0 ;	/* -L */
+    int     rate_bytes       = 0 ;	/* -L NMB */
+    char    unit[4] ;		/* suffix of -O and -L */
+    char    *rest ;		/* after the number of -O */
     int     rule_distr       = RANDOM_DISTRIBUTION ;
     int     rule_failures    = 0 ;		/* Retrials counter */
     float   term_min         = 1 ;
@@ -369,11 +948,14 @@ int main(int argc, char *argv[])
     /* default name for predicted attribute */
     strcpy(class_name, CLASS_NAME) ;
 
+    /* nothing allocated yet */
+    memset(keep, 0, sizeof(struct Build)) ;
+
 
     /* Clearly too few parameters */
     if (argc <= 1) {
 	fprintf(stderr, "ERROR: Too few parameters. See %s -help.\n", program_name) ;
-	exit(2) ;
+	fail(2) ;
     }
 
 
@@ -384,12 +966,18 @@ int main(int argc, char *argv[])
     { 
 	char c ;        	/* contains the current parameter flag */
 	extern char *optarg ;
+	extern int optind ;
 
 	/* defaults */
 	verbose=0 ;
+#ifdef __GLIBC__
+	optind=0 ;	/* glibc starts over, its own state included */
+#else
+	optind=1 ;
+#endif
 
 
-	while ((c = getopt(argc, argv, "hvpzcA:e:f:g:I:M:m:P:R:r:O:D:C:T:d:F:X:")) != -1) {
+	while ((c = getopt(argc, argv, "hvpklzcqA:e:f:g:I:i:j:L:M:m:P:R:r:O:o:S:s:t:U:Z:D:C:T:d:F:X:")) != -1) {
 
          if (debug) fprintf(stderr,"debug: getopt switch (%c).\n", c) ;
 
@@ -397,7 +985,8 @@ int main(int argc, char *argv[])
 	   {
 		   case 'h': /* Simple help message */
 			USAGE ;
-			exit(2) ;
+			fail(2) ;
+			break ;
 
 		   case 'v': /* Verbose */
 			verbose=VERBOSE ;
@@ -407,6 +996,18 @@ int main(int argc, char *argv[])
 			random_style=PSEUDORANDOM ;
 			break ;
 
+		   case 'k': /* Counter-based random streams */
+			counter_style=COUNTERRANDOM ;
+			break ;
+
+		   case 'l': /* Defer the attributes no rule tests */
+			deferred=1 ;
+			break ;
+
+		   case 'q': /* No report of a too constrained domain */
+			quiet=1 ;
+			break ;
+
 		   case 'z': /* Debug */
 			debug=DEBUG ;
 			verbose=VERBOSE ;
@@ -419,14 +1020,14 @@ int main(int argc, char *argv[])
 		   case 'A':  /* Number of relevant attributes*/
 			if (sscanf(optarg, "%d", &relevant) != 1) {
 				fprintf(stderr, "ERROR: parameter -A [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 			break ;
 
 		   case 'e':  /* Proportion of erroneous attribute entries */
 			if (sscanf(optarg, "%f", &attrib_error) != 1) {
 				fprintf(stderr, "ERROR: parameter -e [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
 			break ;
@@ -434,7 +1035,7 @@ int main(int argc, char *argv[])
 		   case 'g':  /* Proportion of erroneous class entries */
 			if (sscanf(optarg, "%f", &class_error) != 1) {
 				fprintf(stderr, "ERROR: parameter -g [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
                    break ;
@@ -442,12 +1043,13 @@ int main(int argc, char *argv[])
 		   case 'f':  /* Rule file path */
 			if (sscanf(optarg, "%s", rule_file) != 1) {
 				fprintf(stderr, "ERROR: parameter -f [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
-			if ( ! (rule_fd = fopen(rule_file, "w")) ) {
+			if (rule_fd) fclose(rule_fd) ;
+			if ( ! (keep->rule_fd = rule_fd = fopen(rule_file, "w")) ) {
 				fprintf(stderr, "ERROR: could not open file '%s'\n", rule_file) ;
-				exit(3) ;
+				fail(3) ;
 			}
 
 			break ;
@@ -455,15 +1057,78 @@ int main(int argc, char *argv[])
 		   case 'I':  /* Number of irrelevant attributes */
 			if (sscanf(optarg, "%d", &irrelevant) != 1) {
 				fprintf(stderr, "ERROR: parameter -d [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
                    break ;
 
+		   case 'i':  /* Range of objects */
+			if (sscanf(optarg, "%ld:%ld", &range_start, &range_end) != 2
+				|| range_start < 0 || range_end < range_start) {
+				fprintf(stderr, "ERROR: parameter -i [%s]\n", optarg) ;
+				fail(2) ;
+			}
+			/* object i must not depend on the objects before it */
+			counter_style=COUNTERRANDOM ;
+			break ;
+
+		   case 'j':  /* Number of threads creating objects */
+			if ((sscanf(optarg, "%d", &jobs) != 1) || (jobs < 1)) {
+				fprintf(stderr, "ERROR: parameter -j [%s]\n", optarg) ;
+				fail(2) ;
+			}
+			/* identical output for any -j requires counter streams */
+			counter_style=COUNTERRANDOM ;
+			break ;
+
+		   case 't':  /* Output format */
+			if ((format = format_named(optarg)) < 0) {
+				fprintf(stderr, "ERROR: parameter -t [%s]\n", optarg) ;
+				fail(2) ;
+			}
+			break ;
+
+		   case 'L':  /* Rate limit */
+			l = sscanf(optarg, "%lf%3s", &rate, unit) ;
+			if (l == 2 && strcmp(unit, "MB") == 0) {
+				rate *= 1e6 ;
+				rate_bytes=1 ;
+			}
+			else if (l != 1 || rate <= 0) {
+				fprintf(stderr, "ERROR: parameter -L [%s]\n", optarg) ;
+				fail(2) ;
+			}
+			break ;
+
+		   case 'o':  /* Output path */
+			output_path=optarg ;
+			break ;
+
+		   case 'U':  /* Serve generators over a Unix socket */
+			server_path=optarg ;
+			break ;
+
+		   case 'S':  /* Split the output into parts */
+			if ((sscanf(optarg, "%ld%c", &split, &split_unit) < 1) || (split < 1)
+				|| (split_unit != 0 && split_unit != 'p')) {
+				fprintf(stderr, "ERROR: parameter -S [%s]\n", optarg) ;
+				fail(2) ;
+			}
+			break ;
+
+		   case 'Z':  /* Compressed output */
+			if (strcmp(optarg, "gzip") == 0) compress=Z_DEFAULT_COMPRESSION ;
+			else if ((sscanf(optarg, "gzip:%d", &compress) != 1)
+				|| (compress < 1) || (compress > 9)) {
+				fprintf(stderr, "ERROR: parameter -Z [%s]\n", optarg) ;
+				fail(2) ;
+			}
+			break ;
+
 		   case 'M':  /* Number of masked predicting relevant */
 			if (sscanf(optarg, "%d", &masked) != 1) {
 				fprintf(stderr, "ERROR: parameter -M [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
                    break ;
@@ -471,7 +1136,7 @@ int main(int argc, char *argv[])
 		   case 'm':  /* Proportion of missing attribute-values */
 			if (sscanf(optarg, "%f", &miss_ratio) != 1) {
 				fprintf(stderr, "ERROR: parameter -m [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
                    break ;
@@ -479,7 +1144,7 @@ int main(int argc, char *argv[])
 		   case 'P':  /* Name of predicted-attribute */
 			if (sscanf(optarg, "%s", class_name) != 1) {
 				fprintf(stderr, "ERROR: parameter -P [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
                    break ;
@@ -487,7 +1152,7 @@ int main(int argc, char *argv[])
 		   case 'R':  /* Number of DNF rules */
 			if (sscanf(optarg, "%d", &classes) != 1) {
 				fprintf(stderr, "ERROR: parameter -R [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
 			break ;
@@ -495,28 +1160,44 @@ int main(int argc, char *argv[])
 		   case 'r': /* Rule Distribution Style */
 			if (sscanf(optarg, "%d", &rule_distr) != 1) {
 				fprintf(stderr, "ERROR: parameter -A [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
 			break ;
 
-		   case 'O':  /* Number of objects */
-			if (sscanf(optarg, "%d", &objects) != 1) {
-				fprintf(stderr, "ERROR: parameter -O [%s]\n", optarg) ;
-				exit(2) ;
+		   case 'O':  /* Number of objects, or a stream */
+			if (strcmp(optarg, "inf") == 0) endless=1 ;
+			else if (sscanf(optarg, "%lf%3s", &seconds, unit) == 2 && strcmp(unit, "s") == 0
+					&& seconds > 0) endless=1 ;
+			else {
+				errno = 0 ;
+				objects = strtol(optarg, &rest, 10) ;
+				if (rest == optarg || *rest != '\0' || objects < 0 || errno == ERANGE) {
+					fprintf(stderr, "ERROR: parameter -O [%s]\n", optarg) ;
+					fail(2) ;
+				}
+			}
+			break ;
+
+		   case 's':  /* Random seed */
+			if (sscanf(optarg, "%lu", &seed) != 1) {
+				fprintf(stderr, "ERROR: parameter -s [%s]\n", optarg) ;
+				fail(2) ;
 			}
+			seeded=1 ;
+			random_style=PSEUDORANDOM ;
 			break ;
 
 		   case 'F':  /* Rule default existence and usage ratio */
 			if (sscanf(optarg, "%f", &default_rule) != 1) {
 				fprintf(stderr, "ERROR: parameter -F [%s]\n", optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 			if (debug) fprintf(stderr,"DEBUG: default_rule set to %g.\n", default_rule) ;
 			if (default_rule >= 1.0) {
 				fprintf(stderr, "ERROR: parameter -F [%s] must be set between [0.0, 1.0) in place of [0%%,100%%)\n",
 					optarg) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
 			break ;
@@ -526,14 +1207,14 @@ int main(int argc, char *argv[])
 
                      if (sscanf(optarg, "%s", expression) != 1) {
 			fprintf(stderr, "ERROR: parameter -D [%s]\n", optarg) ;
-			exit(2) ;
+			fail(2) ;
                      }
 		     /* Get the first token */
 		     token=strtok(expression, "/") ;
 
 		     if (sscanf(token, "%d", &dnf_min) != 1) {
 			fprintf(stderr, "ERROR: parameter -D [%s]\n", token) ;
-			exit(2) ;
+			fail(2) ;
                      }
 
 		     /* Get the next token (max) */
@@ -544,14 +1225,14 @@ int main(int argc, char *argv[])
 		     else
 			if (sscanf(token, "%d", &dnf_max) != 1) {
 			  fprintf(stderr, "ERROR: parameter -D [%s]\n", token) ;
-			exit(2) ;
+			fail(2) ;
                         }
 
 		     /* Test whether the given min is less than the given max */
 		     if (dnf_min > dnf_max) {
 			fprintf(stderr, "PARAMETER ERROR in -D. %d > %d\n",
 				dnf_min, dnf_max) ;
-			exit(2) ;
+			fail(2) ;
 		     }
 		   } /* -D */
 
@@ -562,7 +1243,7 @@ int main(int argc, char *argv[])
 
                      if (sscanf(optarg, "%s", expression) != 1) {
 			fprintf(stderr, "ERROR: parameter -C [%s]\n", optarg) ;
-			exit(2) ;
+			fail(2) ;
                      }
 
 		     /* Get the first token */
@@ -570,7 +1251,7 @@ int main(int argc, char *argv[])
 
 		     if (sscanf(token, "%d", &cnf_min) != 1) {
 			fprintf(stderr, "ERROR: parameter -C [%s]\n", token) ;
-			exit(2) ;
+			fail(2) ;
                      }
 
 		     /* Get the next token (max) */
@@ -581,14 +1262,14 @@ int main(int argc, char *argv[])
 		     else
 			if (sscanf(token, "%d", &cnf_max) != 1) {
 			  fprintf(stderr, "ERROR: parameter -C [%s]\n", token) ;
-			exit(2) ;
+			fail(2) ;
                         }
 
 		     /* Test whether the given min is less than the given max */
 		     if (cnf_min > cnf_max) {
 			fprintf(stderr, "PARAMETER ERROR in -C. %d > %d\n",
 				cnf_min, cnf_max) ;
-			exit(2) ;
+			fail(2) ;
 		     }
 		   } /* -C */
 				   
@@ -600,7 +1281,7 @@ int main(int argc, char *argv[])
 
                  if (sscanf(optarg, "%s", expression) != 1) {
 					fprintf(stderr, "ERROR: parameter -T [%s]\n", optarg) ;
-					exit(2) ;
+					fail(2) ;
                  }
 
                  /* Get the first token */
@@ -608,7 +1289,7 @@ int main(int argc, char *argv[])
 
                  if (sscanf(token, "%f", &term_min) != 1) {
 					fprintf(stderr, "ERROR: parameter -T [%s]\n", token) ;
-					exit(2) ;
+					fail(2) ;
                  }
 
                  /* Get the next token (max) */
@@ -620,7 +1301,7 @@ int main(int argc, char *argv[])
 
                  else if (sscanf(token, "%f", &term_max) != 1) {
 					fprintf(stderr, "ERROR: parameter -T [%s]\n", token) ;
-                    exit(2) ;
+                    fail(2) ;
                  }
 
                  /* Test that a positive number is used*/
@@ -628,7 +1309,7 @@ int main(int argc, char *argv[])
 					fprintf(stderr,
                        "PARAMETER ERROR -T must be greater than zero. Not %g.\n",
 						term_min) ;
-					exit(2) ;
+					fail(2) ;
                  }
 
                  /* Test whether both are fixed or both are domain-ratio */
@@ -636,14 +1317,14 @@ int main(int argc, char *argv[])
 					fprintf(stderr,
 						"PARAMETER ERROR with -T %f,%f\n\tboth must be either both integers > 0 or in (0.0,1.0)\n",
 						term_min, term_max) ;
-					exit(2) ;
+					fail(2) ;
                  }
 
                  /* Test whether the given min is less than the given max */
                  if (term_min > term_max) {
 					fprintf(stderr, "PARAMETER ERROR in -T. %2.3f > %2.3f\n",
 						term_min, term_max) ;
-					exit(2) ;
+					fail(2) ;
                  }
 			   } /* -T */
 			   
@@ -670,7 +1351,7 @@ int main(int argc, char *argv[])
 						fprintf(stderr,
 							"PARAMETER ERROR in -d. %f > %f\n",
 							domain_min, domain_max) ;
-						exit(2) ;
+						fail(2) ;
 				 }
 
 			   } /* -d */
@@ -689,7 +1370,7 @@ int main(int argc, char *argv[])
 		/* -X E'X'PLICIT DATA SET DESCRIPTION */
 		/**************************************/
 		   case 'X': { 
-		     char    expression[200], Xtokens[MAX_ATTRIBUTES][20] ;
+		     char    *expression, **Xtokens ;
 		     char    *token, *subtoken, character=0 ;
 		     int     domain, disjnct ;
 		     float   rational ;	/* use to test presence of real num. */
@@ -714,10 +1395,15 @@ int main(int argc, char *argv[])
 		     if (debug) {fprintf(stderr, "debug: decompose -X [%s]\n", optarg);}
 
 		     /* Copy the parameter contents into a variable */
+		     /* (wide data sets make for a long description) */
+			 free(keep->expression) ;
+			 free(keep->xtokens) ;
+			 keep->expression = expression = (char *)malloc(strlen(optarg)+1) ;
+			 keep->xtokens = Xtokens = (char **)malloc((strlen(optarg)/2+1) * sizeof(char *)) ;
 			 if (sscanf(optarg, "%s", expression) != 1) {
 				/* if other than one string then error */
 			   fprintf(stderr, "ERROR: parameter -X [%s]\n", optarg) ;
-			   exit(2) ;
+			   fail(2) ;
 			 }
 
 		     /* Find out the number of specified attributes to */
@@ -728,12 +1414,7 @@ int main(int argc, char *argv[])
 			   token=strtok(NULL, XTOKENSEP) ) {
 
 			   if (debug) {fprintf(stderr, "token [%s]\n", token); }
-			   if (attributes >= MAX_ATTRIBUTES) {
-				fprintf(stderr,
-					"ERROR: There is a limit of MAX_ATTRIBUTES on the number of attributes.\n") ;
-				exit(2) ;
-			   }
-			   strcpy(Xtokens[attributes], token) ;
+			   Xtokens[attributes] = token ;	/* points into expression */
 			   attributes++ ;
 		     }
 		     if (debug) {fprintf(stderr,
@@ -741,19 +1422,11 @@ int main(int argc, char *argv[])
 
 
 		     /* Allocate the space for the Data_Dictionary */
-		     Data_Dictionary = (struct Attribute_def *)calloc(attributes, sizeof(struct Attribute_def)) ;
-			 
-			 
-			 /* clear out the Data_Dictionary by hand */
-			 /* memset and bzero() are competing Unix calls */
-			 /* bzero(Data_Dictionary, attributes*sizeof(struct Attribute_def) ) ; */
-			 {  char *c ; int i ;
-			    c = (char *)Data_Dictionary ;
-				for(i=0 ; i<sizeof(Data_Dictionary); i++) {
-					*c = (char)0 ;
-					c++ ;
-				}
-			 }
+		     free(Data_Dictionary) ;
+		     free(Relevant) ;
+		     keep->dictionary = Data_Dictionary = (struct Attribute_def *)calloc(attributes, sizeof(struct Attribute_def)) ;
+		     keep->attributes = attributes ;
+		     keep->relevant = Relevant = (int *)calloc(attributes, sizeof(int)) ;
 
 
 		     /* Add each attribute definition incrementally */
@@ -802,7 +1475,7 @@ int main(int argc, char *argv[])
 				fprintf(stderr, 
 				  "ERROR in parameter -X with subtoken [%s]: %f > %f\n",
 				  subtoken, rationalmin, rationalmax) ;
-				exit(2) ;
+				fail(2) ;
 			     }
 			  }
 
@@ -813,7 +1486,7 @@ int main(int argc, char *argv[])
 				fprintf(stderr,
 				  "ERROR in parameter -X with subtoken [%s] is negative [%f]\n",
 				  subtoken, rational) ;
-				 exit(2) ;
+				 fail(2) ;
 	 		     }
 			  }
 
@@ -826,7 +1499,7 @@ int main(int argc, char *argv[])
 				fprintf(stderr, 
 					"ERROR in parameter -X with subtoken [%s] neither number nor single character\n",
 					subtoken) ;
-				exit(2) ;
+				fail(2) ;
 			  }
 
 
@@ -862,7 +1535,7 @@ int main(int argc, char *argv[])
 						fprintf(stderr,
 							"PARAMETER ERROR -T must be greater than zero. Not [%g].\n",
 							term_min) ;
-						exit(2) ;
+						fail(2) ;
 	                 }
 					 
 					 /* Test whether both are fixed or both are domain-ratio */
@@ -870,14 +1543,14 @@ int main(int argc, char *argv[])
 						fprintf(stderr,
 							"PARAMETER ERROR with -T %f,%f\n\tboth must be either both integers > 0 or in (0.0,1.0)\n",
 							term_min, term_max) ;
-						exit(2) ;
+						fail(2) ;
 					 }
 					 
 					 /* Test whether the given min is less than the given max */
 					 if (term_min > term_max) {
 						fprintf(stderr, "PARAMETER ERROR in -T. %2.3f > %2.3f\n",
 							term_min, term_max) ;
-						exit(2) ;
+						fail(2) ;
 				     }
 
 				}
@@ -886,7 +1559,7 @@ int main(int argc, char *argv[])
 				  fprintf(stderr,
 					"ERROR in parameter -X with subtoken [%s]: too many numbers\n",
 					subtoken) ;
-				  exit(2) ;
+				  fail(2) ;
 				}
 			  } /* processed dual numbers */
 
@@ -921,7 +1594,7 @@ int main(int argc, char *argv[])
 					if (rational<=0) { fprintf(stderr,
 			               "PARAMETER ERROR -T must be greater than zero. Not [%4.2f].\n",
 							rational) ;
-						exit(2) ;
+						fail(2) ;
 					}
 
 				}
@@ -930,7 +1603,7 @@ int main(int argc, char *argv[])
 				   fprintf(stderr,
 					   "ERROR in parameter -X with subtoken [%s]: too many numbers\n",
 					   subtoken) ;
-				   exit(2) ;
+				   fail(2) ;
 				}
 
 			  } /* processed single number */
@@ -965,7 +1638,7 @@ int main(int argc, char *argv[])
 					  fprintf(stderr, 
 						  "ERROR in parameter -X with subtoken [%c]: undefined specialization\n", 
 						  character) ;
-					  exit(2) ;
+					  fail(2) ;
 					}
 			  } /* character handler */
 
@@ -1000,19 +1673,19 @@ int main(int argc, char *argv[])
 			if (visible & masked) { fprintf(stderr,
 					"ERROR in parameter -X: cannot have both V and M in the same token [%s]\n",
 					subtoken) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
 			if (relevant & irrelevant) { fprintf(stderr,
 					"ERROR in parameter -X: cannot have both R and I in the same token [%s]\n",
 					subtoken) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
 			if (continuous + ordinal + nominal > 1) { fprintf(stderr,
 					"ERROR in parameter -X: cannot have more than one of O, N or C in the same token [%s]\n",
 					subtoken) ;
-				exit(2) ;
+				fail(2) ;
 			}
 
 		    /* Enhancement: test for other invalid combos like nominal and fraction domain */
@@ -1020,6 +1693,11 @@ int main(int argc, char *argv[])
 
 		   } /* foreach -X token */
 
+		   free(expression) ;
+		   free(Xtokens) ;
+		   keep->expression = NULL ;
+		   keep->xtokens = NULL ;
+
 		 } /* -X case switch */
          break ;
 
@@ -1030,6 +1708,16 @@ int main(int argc, char *argv[])
 	} /* process parameters segment */
 
 
+    /* -U: build and serve the generators the clients ask for instead */
+    if (server_path) {
+	if (built) {
+	    fprintf(stderr, "ERROR: parameter -U inside a served generator\n") ;
+	    fail(2) ;
+	}
+	return(serve(server_path, jobs)) ;
+    }
+
+
 
    /* Enhancement: Test that -X was not combined w/others like -A */
 
@@ -1040,8 +1728,15 @@ int main(int argc, char *argv[])
 *********************************************************************/
     if (debug) fprintf(stderr, "debug: INITIALIZE RANDOMNESS\n");
 
+    /* an explicit seed replaces the default pseudo random sequence */
+    if (seeded) {
+	if (debug) fprintf(stderr, "debug: seed=%lu\n", seed) ;
+
+	srand48((long)seed) ;
+    }
+
     /* if not pseudo random stir the pot with time */
-    if (! random_style) {
+    else if (! random_style) {
 
 	time_t	localTime ;
 
@@ -1050,8 +1745,16 @@ int main(int argc, char *argv[])
 	if (debug) fprintf(stderr, "debug: time=%ld\n", (long)localTime) ;
 
 	srand48((long)localTime) ;
+	seed = (unsigned long)localTime ;
     }
 
+    /* The objects draw from their own stream. By default it simply */
+    /* continues the drand48() sequence used to build the rule base. */
+    generator.stream.counter = counter_style ;
+    generator.stream.key[0]  = seed & 0xFFFFFFFFUL ;
+    generator.stream.key[1]  = (seed >> 16 >> 16) & 0xFFFFFFFFUL ;
+    rand_seek(&generator.stream, 0L, 0L) ;
+
 
 
 
@@ -1147,11 +1850,6 @@ int main(int argc, char *argv[])
 
 	  attributes = relevant + irrelevant ;
 	  
-	  if (attributes >= MAX_ATTRIBUTES) { fprintf(stderr,
-				"ERROR: There is a limit of MAX_ATTRIBUTES on the number of attributes.\n") ;
-			exit(2) ;
-	  }
-	  
 	  if (debug) fprintf(stderr,"debug: attributes %d = relevant %d + irrelevant %d\n",
 		attributes, relevant, irrelevant) ;
 
@@ -1160,18 +1858,9 @@ int main(int argc, char *argv[])
 
 
 	  /* Instantiate the data structure */
-	  Data_Dictionary = (struct Attribute_def *)calloc(attributes, sizeof(struct Attribute_def)) ;
-
-	  /* clear out the Data_Dictionary by hand */
-	  /* memset and bzero() are competing Unix calls */
-	  /* bzero(Data_Dictionary, attributes*sizeof(struct Attribute_def) ) ; */
-	  {  char *c ; int i ;
-		c = (char *)Data_Dictionary ;
-		for(i=0 ; i<sizeof(Data_Dictionary); i++) {
-			*c = (char)0 ;
-			c++ ;
-		}
-	  }
+	  keep->dictionary = Data_Dictionary = (struct Attribute_def *)calloc(attributes, sizeof(struct Attribute_def)) ;
+	  keep->attributes = attributes ;
+	  keep->relevant = Relevant = (int *)calloc(attributes+1, sizeof(int)) ;
 
 
 	  /* Set all attr. to irrlev. The next section sets the relevant ones */
@@ -1235,10 +1924,15 @@ int main(int argc, char *argv[])
 
 
     /* Give the attributes a unique human readable name */
-    /* Start with value 1 */
+    /* A..Z, then AA..AZ, BA.. as spreadsheet columns do */
     for (i=0; i<attributes; i++) {
-	Data_Dictionary[i].name[0] = 'A'+i ;
-	Data_Dictionary[i].name[1] = 0 ;
+	char	name[16] ;
+	int	n ;
+
+	for (n=i, l=0; n>=0; n=n/26-1) name[l++] = (char)('A' + n%26) ;
+	Data_Dictionary[i].name = (char *)malloc(l+1) ;
+	for (k=0; k<l; k++) Data_Dictionary[i].name[k] = name[l-1-k] ;
+	Data_Dictionary[i].name[l] = 0 ;
     	if (debug) fprintf(stderr,"debug: Attribute [%d] received name [%s]\n",
 		i+1, Data_Dictionary[i].name) ;
     }
@@ -1308,19 +2002,9 @@ int main(int argc, char *argv[])
     ** TEST THE SELECTED PARAMETER SETTINGS
     *********************************************************************/
 
-    /* we are using a bitmap so we are limited by the int size */
-    if (attributes > MAX_ATTRIBUTES) {
-		fprintf(stderr,
-			"\nERROR: The number of predicting attributes %d\nis greater than current max (const)%d\n",
-			attributes, MAX_ATTRIBUTES) ;
-		fprintf(stderr,
-			"\tYou may update MAX_ATTRIBUTES and recompile.\nSorry for the inconvenience.\n\n") ;
-		exit(2) ;
-    }
-
     if (attributes <= 0) {
 		fprintf(stderr, "\nERROR: 0 Predicting Attributes\n") ;
-		exit(1) ;
+		fail(1) ;
     }
 
 
@@ -1329,7 +2013,66 @@ int main(int argc, char *argv[])
 	fprintf(stderr,
 	   "ERROR in parameter -D: the maximum number of rule disjunctions (%d) requires at least %d relevant attributes. Not the specified %d.\n",
 	   dnf_max, dnf_max+1, relevant) ;
-	exit(1) ;
+	fail(1) ;
+    }
+
+
+    /* The verbose report would be mixed into a binary format */
+    if (verbose && format != OUT_TSV) {
+	fprintf(stderr, "ERROR: -v is only available with -t tsv\n") ;
+	fail(2) ;
+    }
+
+    /* Only the objects and the banner are compressed */
+    if (compress && (verbose || ! TEXT_FORMAT(format))) {
+	fprintf(stderr, "ERROR: -Z is only available with text formats and without -v\n") ;
+	fail(2) ;
+    }
+
+    /* The column files need a directory */
+    if (format == OUT_NPY && output_path == NULL) {
+	fprintf(stderr, "ERROR: -t npy needs -o\n") ;
+	fail(2) ;
+    }
+
+    /* The records are written at their offsets */
+    if (format == OUT_ROWS && output_path == NULL) {
+	fprintf(stderr, "ERROR: -t rows needs -o\n") ;
+	fail(2) ;
+    }
+
+    /* A stream has no end to put a footer or the verbose report at */
+    if (endless && (verbose || split || ! (TEXT_FORMAT(format) || format == OUT_ARROW_STREAM))) {
+	fprintf(stderr, "ERROR: -O %s is only available with text formats or arrows, without -v or -S\n",
+		seconds > 0 ? "Ns" : "inf") ;
+	fail(2) ;
+    }
+
+    /* -i picks objects out of the data set of -O objects */
+    if (range_end >= 0) {
+	if (endless || (objects && range_end > objects)) {
+	    fprintf(stderr, "ERROR: -i %ld:%ld is past the end of -O\n", range_start, range_end) ;
+	    fail(2) ;
+	}
+	objects = range_end - range_start ;
+    }
+
+    /* The rate is kept where the chunks are written in order */
+    if (rate > 0 && (format == OUT_NPY || format == OUT_ROWS)) {
+	fprintf(stderr, "ERROR: -L is not available with -t npy or rows\n") ;
+	fail(2) ;
+    }
+
+    /* The parts go to a directory */
+    if (split && output_path == NULL) {
+	fprintf(stderr, "ERROR: -S needs -o, the directory of the parts\n") ;
+	fail(2) ;
+    }
+
+    /* The verbose report stays on stdout */
+    if (verbose && output_path != NULL) {
+	fprintf(stderr, "ERROR: -v is only available without -o\n") ;
+	fail(2) ;
     }
 
 
@@ -1345,6 +2088,12 @@ int main(int argc, char *argv[])
 	else
 	   fprintf(stdout, "       full:\tRandomness\n") ;
 
+	if (counter_style)
+	   fprintf(stdout, "    counter:\tRandom streams (seed %lu)\n", seed) ;
+
+	if (deferred)
+	   fprintf(stdout, "   deferred:\tUntested attributes drawn after acceptance\n") ;
+
 	if (rule_distr==0)
 	   fprintf(stdout, "       unif:\t%s\n"  , "Rule distribution") ;
 	else if (rule_distr==1)
@@ -1353,7 +2102,7 @@ int main(int argc, char *argv[])
 	   fprintf(stdout, "      stdno:\t%s\n"  , "Rule distribution") ;
 
 	fprintf(stdout, "\n") ;
-	fprintf(stdout, "      %5d:\t%s\n"  , objects, "Objects") ;
+	fprintf(stdout, "      %5ld:\t%s\n"  , objects, "Objects") ;
 	fprintf(stdout, "      %5d:\t%s\n"  , classes, "Classes (non-default)") ;
 	fprintf(stdout, "      %5d:\t%s\n"  , relevant, "Relevant Attributes") ;
 	fprintf(stdout, "      %5d:\t%s\n"  , irrelevant, "Irrelevant Attributes") ;
@@ -1409,7 +2158,8 @@ int main(int argc, char *argv[])
 
       /* Allocate the space for the CNF rule base */
       /* Add one (+1) because of the default rule */
-      Rules = (struct CNF_Rule *)calloc(cnf_rules+1, sizeof(struct CNF_Rule)) ;
+      keep->rules = Rules = (struct CNF_Rule *)calloc(cnf_rules+1, sizeof(struct CNF_Rule)) ;
+      keep->cnf_rules = cnf_rules ;
 
       /* Set the class and default status of the default_rule */
       Rules[0].tail = 0 ;
@@ -1427,6 +2177,7 @@ int main(int argc, char *argv[])
 		   k++;
 		}
 	 }
+      free(components) ;
 
    }
 
@@ -1436,9 +2187,14 @@ int main(int argc, char *argv[])
    ** halt if unable to squeeze another in               **
    *******************************************************/
    rule_failures = 0 ;
+   keep->overlap = overlap = new_overlap_index(Data_Dictionary, attributes, cnf_rules) ;
+
+   /* a rule's attributes, in increasing order, and who is already taken */
+   keep->term_attribute = term_attribute = (int *)calloc(relevant+1, sizeof(int)) ;
+   keep->taken          = taken          = (char *)calloc(attributes, sizeof(char)) ;
+
    for (i=1; i<=cnf_rules; i++) {
-	int            attribute_map[MAX_ATTRIBUTES] ;
-	int            offset, conjuncts ;
+	int            offset, conjuncts, term ;
 	struct Terms   *Term=NULL ;
 	struct Terms   *Term_prev=NULL ;
 	struct Terms   *body=NULL ;
@@ -1454,11 +2210,6 @@ int main(int argc, char *argv[])
 			i, conjuncts, conjuncts+1 ) ;
 
 
-	/* clean the map */
-	{  int i ;
-	   for(i=0; i<MAX_ATTRIBUTES; i++) attribute_map[i]=0 ;
-	}
-
 	/* select a particular set of attributes for this rule */
 	for (j=0; j<=conjuncts; j++) {
 	   int loopcount = 0 ;
@@ -1468,7 +2219,7 @@ int main(int argc, char *argv[])
 	   /** randomly locate a distinct relevant attribute **/
 	   /** test possibilities until an open offset is found **/
 	   for ( offset=int_rand(attributes) ;
-		 (attribute_map[offset]==1) || (Relevant[offset]==0) ;
+		 taken[offset] || (Relevant[offset]==0) ;
 		 offset=int_rand(attributes), loopcount++ ) {
 
 	      if (debug)
@@ -1476,17 +2227,27 @@ int main(int argc, char *argv[])
 			Data_Dictionary[offset].name) ;
 
 		  if (loopcount > 256) {
-			  fprintf(stderr, "ERROR: infinite loop condition 507204720\n") ;
-			  exit(2) ;
+			  /* Mostly irrelevant columns: count off one of */
+			  /* the relevant attributes which are still open */
+			  term = int_rand(relevant - j) ;
+			  for (offset=0; taken[offset] || (Relevant[offset]==0) || term-- > 0; offset++) ;
+			  break ;
 		  }
 	   }
 
-	   attribute_map[offset] = 1 ; /* make the assignment */
+	   taken[offset] = 1 ; /* make the assignment */
+
+	   /* keep the rule's attributes in increasing order */
+	   for (term=j; term>0 && term_attribute[term-1]>offset; term--)
+		term_attribute[term] = term_attribute[term-1] ;
+	   term_attribute[term] = offset ;
    
 	   if (debug) fprintf(stderr, " attr[%s] ",
 			Data_Dictionary[offset].name) ;
 
-	} /* the attribute_map contains the term's attributes */
+	} /* term_attribute contains the term's attributes */
+
+	for (j=0; j<=conjuncts; j++) taken[term_attribute[j]] = 0 ;
 
 	if (debug) fprintf(stderr, "\n") ;
 
@@ -1495,12 +2256,13 @@ int main(int argc, char *argv[])
 	** Foreach term, e.g. A in {} or A in [,] define its    **
 	** dimensions and create its data structure.            **
 	*********************************************************/
-	/* create the head node of the list */
-	body = Term = (struct Terms *)malloc(sizeof(struct Terms)) ;
+	/* create the head node of the list, empty until its term is set */
+	keep->body = body = Term = (struct Terms *)calloc(1, sizeof(struct Terms)) ;
 	f_c_rules = 1 ; 
 
 	/* act on each term sequentially */
-	for (j=0; j<attributes; j++) if (attribute_map[j]==1) {
+	for (term=0; term<=conjuncts; term++) {
+	   j = term_attribute[term] ;
 
 	   Term->attribute = j ;
 
@@ -1523,13 +2285,13 @@ int main(int argc, char *argv[])
 				fprintf(stderr,
 					"ERROR: setsize for attribute [%s] is less than one [%g].\n",
 					Data_Dictionary[j].name, setsize) ;
-				exit(3) ;
+				fail(3) ;
 			}
 			if (setsize > Data_Dictionary[j].dom_max) {
 				fprintf(stderr,
 					"ERROR: setsize for attribute [%s] is bigger than the domain [%g > %g].\n",
 					Data_Dictionary[j].name, setsize, Data_Dictionary[j].dom_max) ;
-				exit(3) ;
+				fail(3) ;
 			}
 
 			/* Set the number of disjuncts for this term */
@@ -1542,6 +2304,8 @@ int main(int argc, char *argv[])
 	
 			/* create the space to hold the values for this term */
 			Term->nominal = (int *)calloc(1+Term->setsize, sizeof(int)) ;
+			Term->members = (unsigned long *)calloc(
+				SET_WORDS(Data_Dictionary[j].dom_max), sizeof(unsigned long)) ;
 
 
 		} /* NOMINAL */
@@ -1556,12 +2320,12 @@ int main(int argc, char *argv[])
 			if (interval < 1) {
 			   fprintf(stderr, "ERROR: Ordinal interval calculated to be < 1 [%d].\n",
 				interval) ;
-			   exit(3) ;
+			   fail(3) ;
 			}
 			if (interval > Data_Dictionary[j].dom_max - Data_Dictionary[j].dom_min) {
 			   fprintf(stderr, "ERROR: Ordinal interval calculated to be < 1 [%g].\n",
 				(int)(Data_Dictionary[j].dom_max - Data_Dictionary[j].dom_min) ) ;
-			   exit(3) ;
+			   fail(3) ;
 			}
 
 			Term->setsize = (int)interval ;
@@ -1583,14 +2347,14 @@ int main(int argc, char *argv[])
 				fprintf(stderr,
 					"\nERROR: term interval on continuous attribute [%s] is smaller than zero [%f].\n",
 					Data_Dictionary[j].name, interval) ;
-				exit(3) ;
+				fail(3) ;
 			}
 			if (interval > Data_Dictionary[j].dom_max - Data_Dictionary[j].dom_min) {
 				fprintf(stderr,
 					"\nERROR: term interval on continuous attribute [%s] -> [%f] is larger than the attribute's domain [%f].\n",
 					Data_Dictionary[j].name, interval,
 					Data_Dictionary[j].dom_max - Data_Dictionary[j].dom_min) ;
-				exit(3) ;
+				fail(3) ;
 			}
 
 			Term->interval = interval ;
@@ -1605,7 +2369,7 @@ int main(int argc, char *argv[])
 
 
 	    /* add a node in the linked list for the next term */
-	    Term->next_term = (struct Terms *)malloc(sizeof(struct Terms)) ;
+	    Term->next_term = (struct Terms *)calloc(1, sizeof(struct Terms)) ;
 	    Term_prev = Term ;
 	    Term = Term->next_term ;
 	}
@@ -1618,7 +2382,8 @@ int main(int argc, char *argv[])
 	** set the values of each term in the subrule **
 	***********************************************/
 	Term = body ;
-	for (j=0; j<attributes; j++) if (attribute_map[j]==1) {
+	for (term=0; term<=conjuncts; term++) {
+	    j = term_attribute[term] ;
 	    
 	    if (Data_Dictionary[j].datatype == CONTINUOUS) {
 
@@ -1736,20 +2501,24 @@ int main(int argc, char *argv[])
 		    if (debug) 
 				fprintf(stderr, " DEBUG: value %d added to disjunct %d\n", seed, k+1) ;
 
-		    /* Let's commit to this value.
-		    ** and then check if it is a repeat
-		    */
-		    Term->nominal[k] = seed ;
-		    for (l=0; l<k; l++)
-				if (Term->nominal[l] == seed) {
-					if (debug) fprintf(stderr, "WARN: %d is a repeat value\n", seed) ;
-					k-- ; /* let's try again */
-				}	        
+		    /* Let's commit to this value unless it is a repeat */
+		    if (SET_HOLDS(Term->members, seed)) {
+				if (debug) fprintf(stderr, "WARN: %d is a repeat value\n", seed) ;
+				k-- ; /* let's try again */
+		    }
+		    else
+				Term->members[seed/WORD_BITS] |= 1UL << (seed%WORD_BITS) ;
 		
 		  }
 
-		  /* Sort the list of values so the are human readable */
-		  qsort(Term->nominal, Term->setsize, sizeof(int), compare_int) ;
+		  /* List the values in order so they are human readable */
+		  /* (skipping empty words: domains can be in the millions) */
+		  for (k=0, l=0; k<Term->setsize; l+=WORD_BITS)
+				if (Term->members[l/WORD_BITS]) {
+				   int v ;
+				   for (v=l; v<l+WORD_BITS; v++)
+					if (SET_HOLDS(Term->members, v)) Term->nominal[k++] = v ;
+				}
 
 		  if (debug) { /* print out the values in this term */
 			int base ;
@@ -1767,7 +2536,7 @@ int main(int argc, char *argv[])
 	    else {
 			fprintf(stderr, "ERROR in assigning a rule term's value\n") ;
 			fprintf(stderr, "neither continous, ordinal or nominal\n") ;
-			exit(3) ;
+			fail(3) ;
 	    }
 	
 
@@ -1793,7 +2562,8 @@ int main(int argc, char *argv[])
 	   Term = body ;
 
 		/* for each attribute   used by the rule */
-	   for (j=0, firstA=1; j<attributes; j++) if (attribute_map[j]==1) {
+	   for (firstA=1; Term != NULL; ) {
+			j = Term->attribute ;
 
 			/* time for an ampersand & */
 			if (firstA) firstA=!firstA ;
@@ -1858,7 +2628,7 @@ int main(int argc, char *argv[])
 			else { /* ERROR */
 					fprintf(stderr, "ERROR: unknown condition 84792740 [%d][%d].\n",
 						Data_Dictionary[j].datatype, Data_Dictionary[j].testtype) ;
-					exit(3) ;
+					fail(3) ;
 				}
 			
 			
@@ -1875,165 +2645,35 @@ int main(int argc, char *argv[])
 
 	/************************************************
 	** Test this new rule against all current rules **
+	** The overlap index only looks at committed    **
+	** rules which share a region with the new one. **
 	************************************************/
-	New_rule_ok = 1 ;
-
-	for (k=1; k<i; k++) { /* for each commited rule */
-	   /* let's count the number of matches and mismatches for each rule */
-	   struct Terms *Term2 ;
-	   int matches = 0 ;
-	   int mismatches = 0 ;
-
-	   Term=body ;
-	   Term2=Rules[k].body ;
-
-	   if (debug) fprintf(stderr, "debug: test against commited rule k=%d\n", k) ;
-
-	   /* test the two rules one term at a time*/
-	   for (j=0; j<attributes; j++) {
-		/* If both rules reference this dimension
-		   then test the specific values */
-
-		if (debug) fprintf(stderr, "debug: attr j=%d\n", j) ;
-
-		/* do both terms reference this attribute? */
-		if ((attribute_map[j]==1) && (Rules[k].attribute_map[j]==1)) {
-			if (Data_Dictionary[j].datatype == NOMINAL) {
-				int i, j ;
-				int term_matches = 0 ;
-
-				/* brute force test of all combinations */
-				for (i=0; i<Term->setsize; i++)
-				for (j=0; j<Term2->setsize; j++) {
-
-				   if (debug) {
-					fprintf(stderr, "debug: test %d == %d? ",
-						Term->nominal[i], Term2->nominal[j]) ;
-				   }
-
-				   if (Term->nominal[i] == Term2->nominal[j]) {
-					term_matches++ ;
-					if (debug) fprintf(stderr,"YES") ;
-				   }
-				   else
-					if (debug) fprintf(stderr,"NO") ;
-
-				   if (debug) fprintf(stderr,"\n") ;
-
-
-				} /* for all combinations */
-
-				if (term_matches>0) matches++ ; 
-				else mismatches++ ;
-			}
-
-			else if (Data_Dictionary[j].datatype == ORDINAL) {
-
-					  if (debug) {
-						fprintf(stderr, "debug: test [%d,%d] within [%d,%d]?\n",
-							Term->ordinal[0], Term->ordinal[1],
-							Term2->ordinal[0], Term2->ordinal[1]) ;
-					  }
-
-					  /* test both ends of the range */
-					  if ((Term->ordinal[0]>=Term2->ordinal[0])
-							&& (Term->ordinal[0]<=Term2->ordinal[1]))
-						matches++ ; 
-					  else if  ((Term->ordinal[1]>=Term2->ordinal[0])
-							&& (Term->ordinal[1]<=Term2->ordinal[1]))
-						matches++ ; 
-					  else
-						mismatches++ ;
-			}
-
-			else if (Data_Dictionary[j].datatype == CONTINUOUS) {
-
-					  if (debug) {
-						fprintf(stderr, "debug: test [%g,%g] within [%g,%g]?\n",
-							Term->continuous[0], Term->continuous[1],
-							Term2->continuous[0], Term2->continuous[1]) ;
-					  }
-
-					  /* test both ends of the range */
-					  if ((Term->continuous[0]>=Term2->continuous[0])
-							&& (Term->continuous[0]<=Term2->continuous[1]))
-						matches++ ; 
-					  else if  ((Term->continuous[1]>=Term2->continuous[0])
-							&& (Term->continuous[1]<=Term2->continuous[1]))
-						matches++ ; 
-					  else
-						mismatches++ ;
-			}
-
-			if (debug) fprintf(stderr,"j[%d] ", j) ;
-
-		} /* both terms reference the attribute */
-
-		/* Else if only one of the rules references this dimension
-		   then the other is free over the dimension and there is a
-		   conflict (limbo effect) e.g. IF A=1 THEN C1 IF B=1 THEN C2 */
-			
-		else if ((Rules[k].attribute_map[j]==1)
-					|| (attribute_map[j]==1)) {
-
-			matches++ ; 
-
-			if (debug && (Rules[k].attribute_map[j]==1))
-				fprintf(stderr,"debug: only the commited rule references this attribute\n") ;
-			else if (debug)
-				fprintf(stderr,"debug: only the new rule references this attribute\n") ;
-		}
-
-		/* advance to the next term */
-		if (attribute_map[j]==1) {
-			Term = Term->next_term ;
-			if (debug) fprintf(stderr,"debug: next term [%p] in new rule\n", Term) ;
-		}
-		if (Rules[k].attribute_map[j]==1) {
-			Term2 = Term2->next_term ;
-			if (debug) fprintf(stderr,"debug: next term [%p] in commited rule [%d]\n",
-				Term2, k) ;
-		}
-
-	   } /* move onto the next term */
-
+	k = overlap_conflict(overlap, body) ;
+	New_rule_ok = (k == 0) ;
 
-	   /* If there were matches and no mismatches
-		   then there is an overlap so we need to try again. */
-	   if (matches && ! mismatches) {
-		New_rule_ok = 0 ; /* FALSE */
-		if (debug) fprintf(stderr,
-			"\nWARN: New subrule %d conflicts with subrule %d.\n", i+1, k+1) ;
-
-		/* terminate the three loops */
-		k=i-1 ;
-	   }
-	   else {
-		if(debug)
-			fprintf(stderr, " matches=%d, mismatches=%d\n",matches, mismatches) ;
-	   }
-
-	} /* move onto the next rule */
+	if (debug && k) fprintf(stderr,
+		"\nWARN: New subrule %d conflicts with subrule %d.\n", i+1, k+1) ;
 
 
 	if ( New_rule_ok ) {
 	    /* Accept this new rule */
 	    Rules[i].body = body ;
-		{ int j ;
-		  for (j=0;j<MAX_ATTRIBUTES;j++)
-			  Rules[i].attribute_map[j]=attribute_map[j] ;
-		}
 	    Rules[i].conjuncts = conjuncts ;
 	    Rules[i].objects = 0 ;
+	    keep->body = NULL ;
+	    overlap_insert(overlap, i, body) ;
 	}
 
 	else {
 	    /* FAIL: Rule creation has occurred too often */
 	    if (rule_failures++ > FAILURES_PER_RULE * cnf_rules) {
-		fprintf(stderr, "\nEXCEPTION:\n\tFailed to create a RULE base.\n") ;
-		fprintf(stderr, "\tThis domain appears to be too constrained!\n\n") ;
-		fprintf(stderr, "\tIncrease the sizes of your attribute domains.\n\n") ;
-		exit(1) ;
+		if (! quiet) {
+		   fprintf(stderr, "\nEXCEPTION:\n\tFailed to create a RULE base.\n") ;
+		   fprintf(stderr, "\tThis domain appears to be too constrained!\n\n") ;
+		   fprintf(stderr, "\tIncrease the sizes of your attribute domains.\n\n") ;
+		}
+
+		fail(1) ;
 	    }
 
 	    /*
@@ -2045,12 +2685,22 @@ int main(int argc, char *argv[])
 	    while(Term != NULL) {
 		Term_prev = Term ;
 		Term = Term_prev->next_term ;
+		if (Data_Dictionary[Term_prev->attribute].datatype == NOMINAL) {
+			free(Term_prev->nominal) ;
+			free(Term_prev->members) ;
+		}
 		free(Term_prev) ;
 	    }
+	    keep->body = NULL ;
 	}
 
     } /* for each i cnf_rule */
 
+    free_overlap_index(overlap) ;
+    free(term_attribute) ;
+    free(taken) ;
+    free(Relevant) ;
+
 
 
 
@@ -2117,16 +2767,7 @@ int main(int argc, char *argv[])
 
     } /* verbose banner presented */
 
-    else if (column_banner) {
-	/********************************************
-	** A plain attribute banner is the default **
-	********************************************/
-	for (k=0, l=0; k<attributes; k++, l++)
-	    if ( !(Data_Dictionary[k].masked) )
-		printf("%s\t", Data_Dictionary[k].name ) ;
-
-	printf("%s\n", class_name) ;
-    }
+    /* A plain attribute banner (-c) heads each output file, see format_banner() */
   
     fflush(stdout) ;
 
@@ -2135,535 +2776,4094 @@ int main(int argc, char *argv[])
     /***************************************************************
     ** Create objects one at a time.                              **
     ** ensure that only one rule could have created this object.  **
+    ** With -j chunks of objects are created by parallel threads  **
+    ** and written in their original order.                       **
     ***************************************************************/
-    object_failures = 0 ;
-    for (i=0; i<objects; i++) {
-		struct Terms	*Term ;
-		object			new_object ;
-		int				New_object_ok=0 ; /* assume not okay */
+    generator.dictionary   = Data_Dictionary ;
+    generator.attributes   = attributes ;
+    generator.classes      = classes ;
+    generator.cnf_rules    = cnf_rules ;
+    generator.objects      = objects ;
+    generator.rule_distr   = rule_distr ;
+    generator.default_rule = default_rule ;
+    generator.miss_ratio   = miss_ratio ;
+    generator.attrib_error = attrib_error ;
+    generator.class_error  = class_error ;
+    generator.deferred     = deferred ;
+    generator.quiet        = quiet ;
+    generator.format       = format ;
+    generator.path         = output_path ;
+    generator.compress     = compress ;
+    generator.banner       = column_banner && ! verbose ;
+    generator.first        = range_start ;
+    generator.endless      = endless ;
+    generator.seconds      = endless ? seconds : 0 ;
+    generator.rate         = rate ;
+    generator.rate_bytes   = rate_bytes ;
+    generator.rule_fd      = rule_fd ;
+    generator.rules        = Rules ;
+    generator.flat         = flatten_rules(&generator) ;
+    build_labels(Data_Dictionary, attributes) ;
+    generator.index        = build_match_index(&generator) ;
+
+    if (built) {
+	/* a built generator writes no rule file */
+	if (rule_fd) fclose(rule_fd) ;
+	generator.rule_fd = NULL ;
+	*built = generator ;
+	return(0) ;
+    }
 
+    if (split_unit == 'p')	/* a number of parts */
+	split = objects ? (objects + split - 1) / split : 1 ;
 
-	/******************
-	** Select a Rule **
-	******************/
+    /* A stream ends cleanly on SIGINT, SIGTERM or when its reader goes */
+    if (endless) {
+	signal(SIGINT, on_signal) ;
+	signal(SIGTERM, on_signal) ;
+	signal(SIGUSR1, on_signal) ;
+	signal(SIGPIPE, SIG_IGN) ;
+    }
 
-	/* First, is there a default rule? */
-	if (n_rand(1.0) < default_rule) {
-	   j = 0 ; /* 0 is the default */
-	   if(debug)
-		   fprintf(stderr, "DEBUG: use default rule [%d].\n", j) ;
-	}
-	/* select a rule from the rule base*/
-	else {
-	   if (rule_distr == UNIFORM_DISTRIBUTION ) {
-	        if(debug) fprintf(stderr, "DEBUG: rule [%d] (uniform distribution).\n", j) ;
-			j =  1 + (i % cnf_rules) ;
-		}
+    if (split)
+	create_parts(&generator, jobs, split) ;
+    else
+	create_objects(&generator, jobs) ;
 
-	   else if (rule_distr == RANDOM_DISTRIBUTION ) {
-		/* Select a random rule */
-		   j= 1 + int_rand(cnf_rules) ;
-		   if(debug) fprintf(stderr, "DEBUG: rule [%d] (rand distribution).\n", j) ;
-		}
 
-	   else /* Select a random rule with bias*/ {
-		   j= 1 + (int)(cnf_rules*sn_rand()) ;
-		   if(debug) fprintf(stderr, "DEBUG: rule [%d] (biased rand distribution).\n", j) ;
-		}
-	}
 
-	/* while a valid object for this rules has not been created */
-	while (New_object_ok==0) {
 
+   /*********************************************************************
+   ** Display Rules (when verbose)
+   *********************************************************************/
+    
+   if (rule_fd) {
+	dump_rules(&generator) ;
+	fclose(rule_fd) ;
+   }
+   else if (verbose)
+	report_rules(&generator, stdout) ;
 
-	/************************************************
-	** Create an object which abides by this rule. **
-	************************************************/
-	Term=Rules[j].body ;
-	for (k=0; k<attributes; k++) {
 
-	    /* Is this attribute represented in this rule? */
-	    if (Rules[j].attribute_map[k]==1) { /* YES */
-            /* Pick a value for this attribute */
+   if (debug) fprintf(stderr, "\nAbout to exit\n", i);
 
-		if (Data_Dictionary[k].datatype == NOMINAL) {
-			new_object[k] = (float)Term->nominal[int_rand(Term->setsize )] ;
-		}
-		else if (Data_Dictionary[k].datatype == ORDINAL) {
-			new_object[k] = (float)(Term->ordinal[0] + 
-				int_rand(1 + Term->ordinal[1] - Term->ordinal[0])) ;
-				/* added +1 to include the max value */
-		}
-		else if (Data_Dictionary[k].datatype == CONTINUOUS) {
-			new_object[k] = (float)(Term->continuous[0] + 
-				(n_rand()*(Term->continuous[1]-Term->continuous[0])) ) ;
-		}
-		else {
-		   fprintf(stderr, "\nERROR 19274494.\n") ;
-		   exit(3) ;
-		}
 
-		/* Go to the next term in the rule */
-		Term=Term->next_term ;
-	    }
 
-	    else { /* Not covered by a rule so randomly choose a value */
 
-		if (debug) fprintf(stderr, " randval[%d] ", k) ;
+   return(0) ;
 
-		if (Data_Dictionary[k].datatype == NOMINAL) {
-			int random_nominal = 1 + int_rand((int)Data_Dictionary[k].dom_max) ;
+} /* end of datgen_main() */
 
-			new_object[k] = (float)random_nominal ;
+
+
+/*****************************************************************
+******************************************************************
+** LIBRARY PROCEDURES						**
+******************************************************************
+*****************************************************************/
+
+/*****************************************************************************
+** datgen_config_init()
+**
+** The datgen defaults: what the program does without the option.
+*****************************************************************************/
+void datgen_config_init(struct datgen_config *config) {
+
+   memset(config, 0, sizeof(struct datgen_config)) ;
+   config->domain[0] = 0 ;
+   config->domain[1] = 1 ;
+   config->term[0]   = 1 ;
+   config->term[1]   = 1 ;
+   config->rule_distribution = RANDOM_DISTRIBUTION ;
+   config->attribute_spec    = NULL ;
+   config->class_name        = NULL ;
+}
+
+
+/*************************************
+** Append the option flag and its value, which the caller then fills in.
+*************************************/
+static char *add_option(char *argv[], int *argc, char *flag, char *value)
+{
+	argv[(*argc)++] = flag ;
+	argv[(*argc)++] = value ;
+	return(value) ;
+}
+
+
+/*****************************************************************************
+** datgen_open()
+**
+** Build a generator: the data dictionary, the rule base and the match
+** index, by running datgen_main() on the options the config stands for.
+** Options at their default are left out, as the program would see them.
+*****************************************************************************/
+int datgen_open(const struct datgen_config *config, struct datgen **generator) {
+   char			values[20][64], *argv[48] ;
+   int			argc = 0, n = 0 ;
+
+   *generator = NULL ;
+
+   argv[argc++] = "libdatgen" ;
+   argv[argc++] = "-k" ;
+   sprintf(add_option(argv, &argc, "-s", values[n++]), "%lu", config->seed) ;
+   if (config->relevant)
+	sprintf(add_option(argv, &argc, "-A", values[n++]), "%d", config->relevant) ;
+   if (config->irrelevant)
+	sprintf(add_option(argv, &argc, "-I", values[n++]), "%d", config->irrelevant) ;
+   if (config->masked)
+	sprintf(add_option(argv, &argc, "-M", values[n++]), "%d", config->masked) ;
+   if (config->rules)
+	sprintf(add_option(argv, &argc, "-R", values[n++]), "%d", config->rules) ;
+   if (config->domain[0] != 0 || config->domain[1] != 1)
+	sprintf(add_option(argv, &argc, "-d", values[n++]), "%.9g/%.9g", config->domain[0], config->domain[1]) ;
+   if (config->conjuncts[0] || config->conjuncts[1])
+	sprintf(add_option(argv, &argc, "-C", values[n++]), "%d/%d", config->conjuncts[0], config->conjuncts[1]) ;
+   if (config->disjuncts[0] || config->disjuncts[1])
+	sprintf(add_option(argv, &argc, "-D", values[n++]), "%d/%d", config->disjuncts[0], config->disjuncts[1]) ;
+   if (config->term[0] != 1 || config->term[1] != 1)
+	sprintf(add_option(argv, &argc, "-T", values[n++]), "%.9g/%.9g", config->term[0], config->term[1]) ;
+   if (config->rule_distribution != RANDOM_DISTRIBUTION)
+	sprintf(add_option(argv, &argc, "-r", values[n++]), "%d", config->rule_distribution) ;
+   if (config->default_rule)
+	sprintf(add_option(argv, &argc, "-F", values[n++]), "%.9g", config->default_rule) ;
+   if (config->missing)
+	sprintf(add_option(argv, &argc, "-m", values[n++]), "%.9g", config->missing) ;
+   if (config->attribute_errors)
+	sprintf(add_option(argv, &argc, "-e", values[n++]), "%.9g", config->attribute_errors) ;
+   if (config->class_errors)
+	sprintf(add_option(argv, &argc, "-g", values[n++]), "%.9g", config->class_errors) ;
+   if (config->class_name) {
+	if (strlen(config->class_name) >= sizeof(class_name)) return(DATGEN_PARAMETER) ;
+	strcpy(add_option(argv, &argc, "-P", values[n++]), config->class_name) ;
+   }
+   if (config->deferred)
+	argv[argc++] = "-l" ;
+   if (config->quiet)
+	argv[argc++] = "-q" ;
+   if (config->attribute_spec) {
+	argv[argc++] = "-X" ;
+	argv[argc++] = (char *)config->attribute_spec ;
+   }
+   argv[argc] = NULL ;
+
+   return(build_datgen(argc, argv, generator)) ;
+}
+
+
+/*****************************************************************************
+** build_datgen()
+**
+** Run datgen_main() on the options in argv up to the finished rule base
+** and keep what it built as a generator. fail() comes back here with its
+** exit code, and what had been allocated up to then is freed. The server
+** of -U builds its generators this way too.
+*****************************************************************************/
+int build_datgen(int argc, char *argv[], struct datgen **generator) {
+   struct Generator	gen ;
+   struct Build		partial ;
+   struct datgen	*g ;
+   jmp_buf		env ;
+   int			code, c, k ;
+
+   *generator = NULL ;
+   pthread_once(&failure_once, failure_key_create) ;
+
+   /* fail() comes back here with its exit code */
+   if ((code = setjmp(env)) != 0) {
+	pthread_setspecific(failure_key, NULL) ;
+	free_build(&partial) ;
+	return(code) ;
+   }
+   pthread_setspecific(failure_key, &env) ;
+   datgen_main(argc, argv, &gen, &partial) ;
+   pthread_setspecific(failure_key, NULL) ;
+
+   g = new_datgen(&gen) ;
+   if (g == NULL || (g->users = (int *)malloc(sizeof(int))) == NULL) {
+	datgen_close(g) ;
+	free_generator(&gen) ;
+	return(DATGEN_ERROR) ;
+   }
+   *g->users = 1 ;
+   strcpy(g->class_name, class_name) ;
+
+   *generator = g ;
+   return(DATGEN_OK) ;
+}
+
+
+/*****************************************************************************
+** new_datgen()
+**
+** A generator on the rule base of gen, at object 0, with its own worker
+** and buffers. NULL when out of memory.
+*****************************************************************************/
+struct datgen *new_datgen(struct Generator *gen) {
+   struct datgen	*g ;
+   int			c, k ;
+
+   g = (struct datgen *)calloc(1, sizeof(struct datgen)) ;
+   if (g == NULL) return(NULL) ;
+   g->gen         = *gen ;
+   g->gen.endless = 1 ;	/* no end: failures are measured against the objects so far */
+
+   g->worker.gen          = &g->gen ;
+   g->worker.stream       = g->gen.stream ;
+   g->worker.rule_objects = (int *)calloc(gen->cnf_rules+1, sizeof(int)) ;
+   g->worker.match_sets   = (unsigned long **)calloc(gen->index->used+1, sizeof(unsigned long *)) ;
+   g->new_object          = (object)malloc((gen->attributes+1) * sizeof(float)) ;
+   g->erroneous           = (char *)malloc((size_t)gen->attributes+1) ;
+   g->attribute           = (int *)malloc((gen->attributes+1) * sizeof(int)) ;
+
+   if (g->worker.rule_objects == NULL || g->worker.match_sets == NULL
+	|| g->new_object == NULL || g->erroneous == NULL || g->attribute == NULL) {
+	datgen_close(g) ;
+	return(NULL) ;
+   }
+
+   for (k=0, c=0; k<gen->attributes; k++)
+	if (! gen->dictionary[k].masked) g->attribute[c++] = k ;
+   g->attribute[c++] = gen->attributes ;	/* the class */
+   g->columns = c ;
+
+   return(g) ;
+}
+
+
+/*****************************************************************************
+** datgen_clone()
+**
+** Another generator on the rule base of g, at object 0: it creates the
+** same objects as g, from a worker of its own, so the two may fill their
+** batches in parallel threads. The rule base goes with the last of them
+** to be closed.
+*****************************************************************************/
+int datgen_clone(struct datgen *g, struct datgen **copy) {
+   struct datgen	*c ;
+
+   *copy = NULL ;
+   if (g == NULL) return(DATGEN_PARAMETER) ;
+   if ((c = new_datgen(&g->gen)) == NULL) return(DATGEN_ERROR) ;
+
+   c->users = g->users ;
+   (*c->users)++ ;
+   strcpy(c->class_name, g->class_name) ;
+
+   *copy = c ;
+   return(DATGEN_OK) ;
+}
+
+
+/*****************************************************************************
+** free_build()
+**
+** Free what a build which failed had allocated: the -X tokens, the data
+** dictionary, the rules drawn so far and the rule being drawn with the
+** working space of the rule base, and close its rule file.
+*****************************************************************************/
+void free_build(struct Build *b) {
+   struct Terms		*term, *next ;
+   int			i ;
+
+   free(b->expression) ;
+   free(b->xtokens) ;
+
+   for (term=b->body; term != NULL; term=next) {
+	next = term->next_term ;
+	free(term->nominal) ;
+	free(term->members) ;
+	free(term) ;
+   }
+   if (b->rules != NULL) {
+	free_rules(b->rules, b->cnf_rules, b->dictionary) ;
+	if (Rules == b->rules) Rules = NULL ;
+   }
+   if (b->overlap != NULL) free_overlap_index(b->overlap) ;
+   free(b->term_attribute) ;
+   free(b->taken) ;
+   free(b->relevant) ;
+
+   if (b->dictionary != NULL) {
+	for (i=0; i<b->attributes; i++)
+	   free(b->dictionary[i].name) ;
+	free(b->dictionary) ;
+   }
+   if (b->rule_fd != NULL) fclose(b->rule_fd) ;
+}
+
+
+/*****************************************************************************
+** datgen_columns(), datgen_column()
+**
+** The visible attributes, in order, then the class.
+*****************************************************************************/
+int datgen_columns(struct datgen *g) {
+   return(g->columns) ;
+}
+
+int datgen_column(struct datgen *g, int c, struct datgen_column *info) {
+   struct Attribute_def	*attribute ;
+
+   if (c < 0 || c >= g->columns) return(DATGEN_PARAMETER) ;
+
+   if (c == g->columns-1) {
+	info->name   = g->class_name ;
+	info->type   = DATGEN_CLASS ;
+	info->values = g->gen.classes + 1 ;
+	info->min    = 0 ;
+	info->max    = (float)g->gen.classes ;
+	return(DATGEN_OK) ;
+   }
+
+   attribute = &g->gen.dictionary[g->attribute[c]] ;
+   info->name   = attribute->name ;
+   info->type   = attribute->datatype == NOMINAL ? DATGEN_NOMINAL
+		: attribute->datatype == ORDINAL ? DATGEN_ORDINAL : DATGEN_CONTINUOUS ;
+   info->values = attribute->datatype == NOMINAL ? (long)attribute->dom_max : 0 ;
+   info->min    = attribute->dom_min ;
+   info->max    = attribute->dom_max ;
+   return(DATGEN_OK) ;
+}
+
+
+/*****************************************************************************
+** datgen_label()
+**
+** The label the text output prints for code of a nominal column or of
+** the class.
+*****************************************************************************/
+int datgen_label(struct datgen *g, int c, int code, char label[DATGEN_LABEL_MAX]) {
+   struct datgen_column	info ;
+   char			buffer[256] ;
+
+   if (datgen_column(g, c, &info) != DATGEN_OK || code < 0 || code >= info.values)
+	return(DATGEN_PARAMETER) ;
+
+   if (info.type == DATGEN_CLASS) sprintf(buffer, "c%d", code) ;
+   else num2str(code+1, buffer) ;
+   buffer[DATGEN_LABEL_MAX-1] = 0 ;
+   strcpy(label, buffer) ;
+   return(DATGEN_OK) ;
+}
+
+
+/*****************************************************************************
+** datgen_seek()
+**
+** Make object the next one datgen_fill_batch() creates.
+*****************************************************************************/
+int datgen_seek(struct datgen *g, long object) {
+
+   if (object < 0) return(DATGEN_PARAMETER) ;
+   g->next = object ;
+   return(DATGEN_OK) ;
+}
+
+
+/*****************************************************************************
+** datgen_fill_batch()
+**
+** Create the next n objects straight into the caller's column buffers,
+** each of room for n values of its type (see datgen.h): no allocation
+** and no stdio.
+*****************************************************************************/
+int datgen_fill_batch(struct datgen *g, long n, void *columns[]) {
+   struct Generator	*gen = &g->gen ;
+   struct Attribute_def	*attribute ;
+   jmp_buf		env ;
+   unsigned int		nan_bits = 0x7FC00000U ;
+   float		nan, x ;
+   long			r ;
+   int			c, j, class, code ;
+
+   if (n < 0) return(DATGEN_PARAMETER) ;
+   memcpy(&nan, &nan_bits, 4) ;
+
+   if ((code = setjmp(env)) != 0) {
+	pthread_setspecific(failure_key, NULL) ;
+	return(code) ;
+   }
+   pthread_setspecific(failure_key, &env) ;
+
+   for (r=0; r<n; r++) {
+	j = create_object(&g->worker, g->next, g->new_object) ;
+	g->worker.rule_objects[j]++ ;
+	class = add_noise(gen, j, g->new_object, g->erroneous, &g->worker.stream) ;
+
+	for (c=0; c<g->columns-1; c++) {
+	   attribute = &gen->dictionary[g->attribute[c]] ;
+	   x = g->new_object[g->attribute[c]] ;
+
+	   if (attribute->datatype == CONTINUOUS)
+		((float *)columns[c])[r] = x == MISSINGVAL ? nan : x ;
+	   else if (attribute->datatype == NOMINAL)
+		((int *)columns[c])[r] = x == MISSINGVAL ? -1 : (int)x - 1 ;
+	   else
+		((int *)columns[c])[r] = x == MISSINGVAL ? INT_MIN : (int)x ;
+	}
+	((int *)columns[c])[r] = class ;
+	g->next++ ;
+   }
+
+   pthread_setspecific(failure_key, NULL) ;
+   return(DATGEN_OK) ;
+}
+
+
+/*****************************************************************************
+** datgen_close()
+*****************************************************************************/
+void datgen_close(struct datgen *g) {
+
+   if (g == NULL) return ;
+
+   /* without users, a generator new_datgen() gave up on owns nothing */
+   if (g->users != NULL && --*g->users == 0) {
+	free_generator(&g->gen) ;
+	free(g->users) ;
+   }
+   free(g->worker.rule_objects) ;
+   free(g->worker.match_sets) ;
+   free(g->new_object) ;
+   free(g->erroneous) ;
+   free(g->attribute) ;
+   free(g) ;
+}
+
+
+/*****************************************************************************
+** free_generator()
+**
+** Free the data dictionary, the rule base and what was derived from it.
+*****************************************************************************/
+void free_generator(struct Generator *gen) {
+   struct Flat_rules	*flat = gen->flat ;
+   struct Match_index	*mi   = gen->index ;
+   int			e, i ;
+
+   free(flat->first) ;
+   free(flat->rule) ;
+   free(flat->attribute) ;
+   free(flat->datatype) ;
+   free(flat->low) ;
+   free(flat->high) ;
+   free(flat->set_first) ;
+   free(flat->set_size) ;
+   free(flat->values) ;
+   free(flat) ;
+
+   for (e=0; e<mi->used; e++) {
+	free(mi->entry[e].points) ;
+	free(mi->entry[e].accept) ;
+   }
+   free(mi->entry) ;
+   free(mi->all) ;
+   free(mi) ;
+
+   free_rules(gen->rules, gen->cnf_rules, gen->dictionary) ;
+   if (Rules == gen->rules) Rules = NULL ;
+
+   for (i=0; i<gen->attributes; i++)
+	free(gen->dictionary[i].name) ;
+   free(gen->dictionary) ;
+}
+
+
+/*****************************************************************************
+** free_rules()
+**
+** Free rules 0 .. cnf_rules with the terms of their bodies.
+*****************************************************************************/
+void free_rules(struct CNF_Rule *rules, int cnf_rules, struct Attribute_def *dictionary) {
+   struct Terms		*term, *next ;
+   int			i ;
+
+   for (i=0; i<=cnf_rules; i++)
+	for (term=rules[i].body; term != NULL; term=next) {
+	   next = term->next_term ;
+	   if (dictionary[term->attribute].datatype == NOMINAL) {
+		free(term->nominal) ;
+		free(term->members) ;
+	   }
+	   free(term) ;
+	}
+   free(rules) ;
+}
+
+
+
+
+/*****************************************************************
+******************************************************************
+** SERVER PROCEDURES						**
+******************************************************************
+*****************************************************************/
+
+/*****************************************************************************
+** serve()
+**
+** -U: keep named generators in memory and create their objects for the
+** clients of a Unix domain socket, one request per connection:
+**
+**	open NAME OPTION ...			build NAME from datgen options
+**	rows NAME START END [FORMAT [PATH]]	objects START to END-1
+**	close NAME				forget NAME
+**	quit					stop serving
+**
+** Each reply starts with a line: OK, or ERROR, the exit code and what
+** went wrong. The objects of rows follow the OK, exactly as datgen -i
+** START:END -t FORMAT [tsv] with the options of NAME prints them, or are
+** written to PATH (a file in /dev/shm is a shared memory segment) before
+** the OK. The data dictionary, the rule base and the match index are
+** built once, by open. Requests are served one after the other, each by
+** jobs threads. A failure in a request, on any of those threads, is its
+** ERROR reply and the server goes on with the next connection.
+*****************************************************************************/
+int serve(char *path, int jobs) {
+   struct sockaddr_un	address ;
+   struct stat		status ;
+   struct Served	*served = NULL, *next ;
+   int			listener, client, quit = 0 ;
+
+   if (strlen(path) >= sizeof(address.sun_path)) {
+	fprintf(stderr, "ERROR: parameter -U [%s] is too long\n", path) ;
+	fail(2) ;
+   }
+   memset(&address, 0, sizeof(address)) ;
+   address.sun_family = AF_UNIX ;
+   strcpy(address.sun_path, path) ;
+
+   /* the socket of a server that was killed is still there */
+   if (stat(path, &status) == 0 && S_ISSOCK(status.st_mode)) unlink(path) ;
+
+   if ((listener = socket(AF_UNIX, SOCK_STREAM, 0)) < 0
+	|| bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0
+	|| listen(listener, SOMAXCONN) != 0) {
+	perror("ERROR: parameter -U") ;
+	fail(3) ;
+   }
+
+   /* a client may go away before its objects */
+   signal(SIGPIPE, SIG_IGN) ;
+   pthread_once(&failure_once, failure_key_create) ;
+
+   while (! quit) {
+	if ((client = accept(listener, NULL, NULL)) < 0) {
+	   if (errno == EINTR || errno == ECONNABORTED) continue ;
+	   perror("ERROR: accepting a client") ;
+	   fail(3) ;
+	}
+	quit = serve_request(client, &served, jobs) ;
+	close(client) ;
+   }
+
+   close(listener) ;
+   unlink(path) ;
+   for ( ; served != NULL; served = next) {
+	next = served->next ;
+	datgen_close(served->generator) ;
+	free(served) ;
+   }
+   return(0) ;
+}
+
+
+/*************************************
+** Write a reply line to the client.
+*************************************/
+static void reply(int client, char *format, ...)
+{
+	char	line[512] ;
+	va_list	args ;
+	long	n, at = 0, length ;
+
+	va_start(args, format) ;
+	vsprintf(line, format, args) ;
+	va_end(args) ;
+
+	length = (long)strlen(line) ;
+	while (at < length) {
+	   n = (long)write(client, line + at, (size_t)(length - at)) ;
+	   if (n < 0 && errno == EINTR) continue ;
+	   if (n <= 0) return ;	/* the client went away */
+	   at += n ;
+	}
+}
+
+
+/*****************************************************************************
+** serve_request()
+**
+** Read the request of a client, a line of words, and answer it. Returns
+** 1 for quit.
+*****************************************************************************/
+int serve_request(int client, struct Served **served, int jobs) {
+   char			request[REQUEST_MAX], *argv[REQUEST_WORDS+2], *word ;
+   char			self[40], *path ;
+   char			*name ;
+   struct Served	**at, *s ;
+   struct datgen	*g ;
+   struct Generator	gen ;
+   jmp_buf		env ;
+   FILE * volatile	rows = NULL ;	/* the objects, before they are sent */
+   long			length = 0, n, start, end ;
+   int			argc = 0, code, format ;
+
+   /* the request ends with its line, or when the client stops writing */
+   while (length < REQUEST_MAX-1 && memchr(request, '\n', (size_t)length) == NULL) {
+	n = (long)read(client, request + length, (size_t)(REQUEST_MAX-1 - length)) ;
+	if (n < 0 && errno == EINTR) continue ;
+	if (n <= 0) break ;
+	length += n ;
+   }
+   request[length] = 0 ;
+   if ((word = strchr(request, '\n')) != NULL) *word = 0 ;
+
+   for (word = strtok(request, " \t\r\n"); word != NULL && argc < REQUEST_WORDS;
+		word = strtok(NULL, " \t\r\n"))
+	argv[argc++] = word ;
+   argv[argc] = NULL ;
+
+   if (argc == 0) {
+	reply(client, "ERROR 2 empty request\n") ;
+	return(0) ;
+   }
+   if (strcmp(argv[0], "quit") == 0) {
+	reply(client, "OK\n") ;
+	return(1) ;
+   }
+   if (argc < 2 || strlen(argv[1]) >= sizeof((*served)->name)) {
+	reply(client, "ERROR 2 %.64s needs a generator name\n", argv[0]) ;
+	return(0) ;
+   }
+
+   name = argv[1] ;
+   for (at = served; *at != NULL && strcmp((*at)->name, name) != 0; at = &(*at)->next) ;
+
+   /* open NAME OPTION ... : datgen_main() sees program_name -k OPTION ...,
+   ** as with -i the objects of a range must not depend on the ones before */
+   if (strcmp(argv[0], "open") == 0) {
+	strcpy(self, program_name) ;
+	memmove(argv+1, argv, (argc+1) * sizeof(char *)) ;
+	argv[1] = self ;
+	argv[2] = "-k" ;
+	if ((code = build_datgen(argc, argv+1, &g)) != DATGEN_OK) {
+	   reply(client, "ERROR %d could not build %s\n", code, name) ;
+	   return(0) ;
+	}
+
+	if (*at == NULL) {
+	   *at = (struct Served *)calloc(1, sizeof(struct Served)) ;
+	   strcpy((*at)->name, name) ;
+	}
+	else datgen_close((*at)->generator) ;
+	(*at)->generator = g ;
+	reply(client, "OK\n") ;
+	return(0) ;
+   }
+
+   if (*at == NULL) {
+	reply(client, "ERROR 2 no generator %s\n", name) ;
+	return(0) ;
+   }
+
+   if (strcmp(argv[0], "close") == 0) {
+	s = *at ;
+	*at = s->next ;
+	datgen_close(s->generator) ;
+	free(s) ;
+	reply(client, "OK\n") ;
+	return(0) ;
+   }
+
+   if (strcmp(argv[0], "rows") != 0) {
+	reply(client, "ERROR 2 unknown request %.64s\n", argv[0]) ;
+	return(0) ;
+   }
+
+   /* rows NAME START END [FORMAT [PATH]] */
+   format = argc > 4 ? format_named(argv[4]) : OUT_TSV ;
+   path   = argc > 5 ? argv[5] : NULL ;
+   if (argc < 4 || argc > 6 || sscanf(argv[2], "%ld", &start) != 1 || sscanf(argv[3], "%ld", &end) != 1
+	|| start < 0 || end < start) {
+	reply(client, "ERROR 2 rows NAME START END [FORMAT [PATH]]\n") ;
+	return(0) ;
+   }
+   if (format < 0 || ((format == OUT_NPY || format == OUT_ROWS) && path == NULL)) {
+	reply(client, "ERROR 2 format %.64s%s\n", argv[4], format < 0 ? "" : " needs a PATH") ;
+	return(0) ;
+   }
+
+   /* the run datgen -i START:END makes, from the generator's settings */
+   g = (*at)->generator ;
+   gen = g->gen ;
+   gen.first   = start ;
+   gen.objects = end - start ;
+   gen.endless = 0 ;
+   gen.seconds = 0 ;
+   gen.rate    = 0 ;
+   gen.format  = format ;
+   gen.path    = path ;
+   gen.rule_fd = NULL ;
+   strcpy(class_name, g->class_name) ;
+
+   /* without PATH the objects wait in a file: only a complete run is OK */
+   if (path == NULL && (rows = tmpfile()) == NULL) {
+	reply(client, "ERROR 3 no file for the objects\n") ;
+	return(0) ;
+   }
+
+   if ((code = setjmp(env)) != 0) {
+	pthread_setspecific(failure_key, NULL) ;
+	output_fd = 1 ;
+	if (rows) fclose(rows) ;
+	reply(client, "ERROR %d creating the objects\n", code) ;
+	return(0) ;
+   }
+   pthread_setspecific(failure_key, &env) ;
+
+   if (rows) output_fd = fileno(rows) ;
+   create_objects(&gen, jobs) ;
+   pthread_setspecific(failure_key, NULL) ;
+   output_fd = 1 ;
+
+   reply(client, "OK\n") ;
+   if (rows) {
+	send_rows(client, fileno(rows)) ;
+	fclose(rows) ;
+   }
+   return(0) ;
+}
+
+
+/*****************************************************************************
+** send_rows()
+**
+** Send the objects a request wrote to the file fd on to the client. A
+** client that goes away gets the rest of them no more.
+*****************************************************************************/
+void send_rows(int client, int fd) {
+   char		buffer[65536] ;
+   long		n, at, sent ;
+
+   lseek(fd, (off_t)0, SEEK_SET) ;
+   while ((n = (long)read(fd, buffer, sizeof(buffer))) != 0) {
+	if (n < 0) {
+	   if (errno == EINTR) continue ;
+	   return ;
+	}
+	for (at = 0; at < n; at += sent)
+	   if ((sent = (long)write(client, buffer + at, (size_t)(n - at))) < 0) {
+		if (errno != EINTR) return ;
+		sent = 0 ;
+	   }
+   }
+}
+
+
+
+
+
+/*****************************************************************
+******************************************************************
+** RULE INDEX PROCEDURES					**
+******************************************************************
+*****************************************************************/
+
+/*****************************************************************************
+** new_overlap_index()
+**
+** An empty index of committed rules. Per attribute it keeps the rules
+** with a term on it and, for nominal attributes, one posting bitset per
+** value or, for ordinal and continuous attributes, an interval tree.
+*****************************************************************************/
+struct Overlap_index *new_overlap_index(struct Attribute_def *Data_Dictionary,
+		int attributes, int cnf_rules) {
+   struct Overlap_index	*ov ;
+
+   ov = (struct Overlap_index *)calloc(1, sizeof(struct Overlap_index)) ;
+   ov->dictionary  = Data_Dictionary ;
+   ov->attributes  = attributes ;
+   ov->words       = cnf_rules/WORD_BITS + 1 ;
+   ov->committed   = (unsigned long *)calloc(ov->words, sizeof(unsigned long)) ;
+   ov->hits        = (unsigned long *)calloc(ov->words, sizeof(unsigned long)) ;
+   ov->candidates  = (unsigned long *)calloc(ov->words, sizeof(unsigned long)) ;
+   ov->referencing = (unsigned long **)calloc(attributes, sizeof(unsigned long *)) ;
+   ov->postings    = (unsigned long **)calloc(attributes, sizeof(unsigned long *)) ;
+   ov->tree        = (struct Interval_node **)calloc(attributes, sizeof(struct Interval_node *)) ;
+
+   return(ov) ;
+}
+
+
+/*************************************
+** Free an interval tree.
+*************************************/
+static void free_intervals(struct Interval_node *t) {
+   if (t == NULL) return ;
+   free_intervals(t->left) ;
+   free_intervals(t->right) ;
+   free(t) ;
+}
+
+
+/*************************************
+** Free an overlap index.
+*************************************/
+void free_overlap_index(struct Overlap_index *ov) {
+   int a ;
+
+   for (a=0; a<ov->attributes; a++) {
+	free(ov->referencing[a]) ;
+	free(ov->postings[a]) ;
+	free_intervals(ov->tree[a]) ;
+   }
+   free(ov->referencing) ;
+   free(ov->postings) ;
+   free(ov->tree) ;
+   free(ov->committed) ;
+   free(ov->hits) ;
+   free(ov->candidates) ;
+   free(ov) ;
+}
+
+
+/*****************************************************************************
+** overlap_conflict()
+**
+** Return a committed rule that the new rule (body) conflicts with, or 0.
+** Two rules conflict unless they mismatch on an attribute they both test:
+** nominal sets without a common value, or an interval neither of whose
+** ends lies in the committed rule's interval. A committed rule which does
+** not test one of the new rule's attributes cannot mismatch on it.
+*****************************************************************************/
+int overlap_conflict(struct Overlap_index *ov, struct Terms *body) {
+   struct Terms	*Term ;
+   unsigned long	*candidates = ov->candidates ;
+   unsigned long	*hits = ov->hits ;
+   unsigned long	left ;
+   int			a, k, w ;
+
+   for (w=0; w<ov->words; w++) candidates[w] = ov->committed[w] ;
+
+   for (Term=body; Term != NULL; Term=Term->next_term) {
+	a = Term->attribute ;
+
+	/* no committed rule tests this attribute */
+	if (ov->referencing[a] == NULL) continue ;
+
+	for (w=0; w<ov->words; w++) hits[w] = 0 ;
+
+	if (ov->dictionary[a].datatype == NOMINAL) {
+	   int	set_words = SET_WORDS(ov->dictionary[a].dom_max) ;
+	   long	testing = 0 ;
+
+	   /* candidates which also test this attribute */
+	   for (w=0; w<ov->words; w++)
+		testing += bit_count(candidates[w] & ov->referencing[a][w]) ;
+
+	   /* AND the value sets of a few candidates, */
+	   if (testing * set_words < (long)Term->setsize * ov->words) {
+		for (w=0; w<ov->words; w++) {
+		   left = candidates[w] & ov->referencing[a][w] ;
+		   for (k=w*WORD_BITS; left; k++, left >>= 1)
+			if ((left & 1UL) && sets_overlap(rule_term(k, a)->members,
+					Term->members, set_words))
+			   hits[w] |= 1UL << (k%WORD_BITS) ;
+		}
+	   }
+
+	   /* otherwise OR the postings of the new rule's values */
+	   else for (k=0; k<Term->setsize; k++) {
+		unsigned long *posting = ov->postings[a] + Term->nominal[k]*ov->words ;
+
+		for (w=0; w<ov->words; w++) hits[w] |= posting[w] ;
+	   }
+	}
+	else if (ov->dictionary[a].datatype == ORDINAL) {
+	   interval_stab(ov->tree[a], (float)Term->ordinal[0], hits) ;
+	   interval_stab(ov->tree[a], (float)Term->ordinal[1], hits) ;
+	}
+	else {
+	   interval_stab(ov->tree[a], Term->continuous[0], hits) ;
+	   interval_stab(ov->tree[a], Term->continuous[1], hits) ;
+	}
+
+	/* keep the rules that overlap here or do not test the attribute */
+	for (w=0, left=0; w<ov->words; w++) {
+	   candidates[w] &= hits[w] | ~ov->referencing[a][w] ;
+	   left |= candidates[w] ;
+	}
+	if (! left) return(0) ;
+   }
+
+   for (w=0; w<ov->words; w++) if (candidates[w]) {
+	for (k=w*WORD_BITS, left=candidates[w]; ! (left & 1UL); k++) left >>= 1 ;
+	return(k) ;
+   }
+
+   return(0) ;
+}
+
+
+/*****************************************************************************
+** overlap_insert()
+**
+** Add the terms of the newly committed rule i to the index.
+*****************************************************************************/
+void overlap_insert(struct Overlap_index *ov, int i, struct Terms *body) {
+   struct Terms		*Term ;
+   struct Interval_node	*node ;
+   unsigned long	bit = 1UL << (i%WORD_BITS) ;
+   unsigned long	h ;
+   int			a, k, w = i/WORD_BITS ;
+
+   ov->committed[w] |= bit ;
+
+   for (Term=body; Term != NULL; Term=Term->next_term) {
+	a = Term->attribute ;
+
+	if (ov->referencing[a] == NULL)
+	   ov->referencing[a] = (unsigned long *)calloc(ov->words, sizeof(unsigned long)) ;
+	ov->referencing[a][w] |= bit ;
+
+	if (ov->dictionary[a].datatype == NOMINAL) {
+	   if (ov->postings[a] == NULL)
+		ov->postings[a] = (unsigned long *)calloc(
+			(1 + (int)ov->dictionary[a].dom_max) * ov->words, sizeof(unsigned long)) ;
+	   for (k=0; k<Term->setsize; k++)
+		ov->postings[a][Term->nominal[k]*ov->words + w] |= bit ;
+	   continue ;
+	}
+
+	node = (struct Interval_node *)calloc(1, sizeof(struct Interval_node)) ;
+	if (ov->dictionary[a].datatype == ORDINAL) {
+	   node->low  = (float)Term->ordinal[0] ;
+	   node->high = (float)Term->ordinal[1] ;
+	}
+	else {
+	   node->low  = Term->continuous[0] ;
+	   node->high = Term->continuous[1] ;
+	}
+	node->max  = node->high ;
+	node->rule = i ;
+
+	/* scramble the node count into a priority; no draws are taken */
+	h = (unsigned long)(++ov->nodes) & 0xFFFFFFFFUL ;
+	h = ((h >> 16) ^ h) * 0x45D9F3BUL & 0xFFFFFFFFUL ;
+	h = ((h >> 16) ^ h) * 0x45D9F3BUL & 0xFFFFFFFFUL ;
+	node->priority = (h >> 16) ^ h ;
+
+	ov->tree[a] = interval_insert(ov->tree[a], node) ;
+   }
+}
+
+
+/*************************************
+** Recompute a node's subtree maximum.
+*************************************/
+static void interval_fix(struct Interval_node *t) {
+   t->max = t->high ;
+   if (t->left  && t->left->max  > t->max) t->max = t->left->max ;
+   if (t->right && t->right->max > t->max) t->max = t->right->max ;
+}
+
+
+/*****************************************************************************
+** interval_insert()
+**
+** Insert a node into a treap ordered by low end point and return the new
+** root. Rotations keep higher priorities above lower ones.
+*****************************************************************************/
+struct Interval_node *interval_insert(struct Interval_node *t,
+		struct Interval_node *node) {
+   struct Interval_node *child ;
+
+   if (t == NULL) return(node) ;
+
+   if (node->low < t->low) {
+	t->left = interval_insert(t->left, node) ;
+	if (t->left->priority > t->priority) { /* rotate right */
+	   child = t->left ;
+	   t->left = child->right ;
+	   child->right = t ;
+	   interval_fix(t) ;
+	   t = child ;
+	}
+   }
+   else {
+	t->right = interval_insert(t->right, node) ;
+	if (t->right->priority > t->priority) { /* rotate left */
+	   child = t->right ;
+	   t->right = child->left ;
+	   child->left = t ;
+	   interval_fix(t) ;
+	   t = child ;
+	}
+   }
+
+   interval_fix(t) ;
+   return(t) ;
+}
+
+
+/*****************************************************************************
+** interval_stab()
+**
+** Set the bit of every rule whose interval contains x.
+*****************************************************************************/
+void interval_stab(struct Interval_node *t, float x, unsigned long *hits) {
+
+   while (t != NULL && t->max >= x) {
+	interval_stab(t->left, x, hits) ;
+
+	/* the right subtree starts at or after t->low */
+	if (t->low > x) return ;
+
+	if (x <= t->high)
+	   hits[t->rule/WORD_BITS] |= 1UL << (t->rule%WORD_BITS) ;
+
+	t = t->right ;
+   }
+}
+
+
+/*****************************************************************************
+** flatten_rules()
+**
+** Copy the finished rule base into parallel arrays of terms. Rule n's
+** terms are first[n] .. first[n+1]-1, in attribute order, and a nominal
+** term's values are values[set_first[t]] onwards.
+*****************************************************************************/
+struct Flat_rules *flatten_rules(struct Generator *gen) {
+   struct Attribute_def	*Data_Dictionary = gen->dictionary ;
+   struct Flat_rules	*flat ;
+   struct Terms		*Term ;
+   int			n, k, t, v, terms=0, values=0 ;
+
+   for (n=0; n<=gen->cnf_rules; n++)
+	for (Term=gen->rules[n].body; Term != NULL; Term=Term->next_term) {
+	   terms++ ;
+	   if (Data_Dictionary[Term->attribute].datatype == NOMINAL)
+		values += Term->setsize ;
+	}
+
+   flat = (struct Flat_rules *)calloc(1, sizeof(struct Flat_rules)) ;
+   flat->rules     = gen->cnf_rules ;
+   flat->terms     = terms ;
+   flat->first     = (int *)calloc(gen->cnf_rules+2, sizeof(int)) ;
+   flat->rule      = (int *)calloc(terms+1, sizeof(int)) ;
+   flat->attribute = (int *)calloc(terms+1, sizeof(int)) ;
+   flat->datatype  = (char *)calloc(terms+1, sizeof(char)) ;
+   flat->low       = (float *)calloc(terms+1, sizeof(float)) ;
+   flat->high      = (float *)calloc(terms+1, sizeof(float)) ;
+   flat->set_first = (int *)calloc(terms+1, sizeof(int)) ;
+   flat->set_size  = (int *)calloc(terms+1, sizeof(int)) ;
+   flat->values    = (int *)calloc(values+1, sizeof(int)) ;
+
+   for (n=0, t=0, v=0; n<=gen->cnf_rules; n++) {
+	flat->first[n] = t ;
+
+	for (Term=gen->rules[n].body; Term != NULL; Term=Term->next_term, t++) {
+	   flat->rule[t]      = n ;
+	   flat->attribute[t] = Term->attribute ;
+	   flat->datatype[t]  = Data_Dictionary[Term->attribute].datatype ;
+
+	   if (flat->datatype[t] == NOMINAL) {
+		flat->set_first[t] = v ;
+		flat->set_size[t]  = Term->setsize ;
+		for (k=0; k<Term->setsize; k++) flat->values[v++] = Term->nominal[k] ;
+	   }
+	   else if (flat->datatype[t] == ORDINAL) {
+		flat->low[t]  = (float)Term->ordinal[0] ;
+		flat->high[t] = (float)Term->ordinal[1] ;
+	   }
+	   else {
+		flat->low[t]  = Term->continuous[0] ;
+		flat->high[t] = Term->continuous[1] ;
+	   }
+	}
+   }
+   flat->first[gen->cnf_rules+1] = t ;
+
+   return(flat) ;
+}
+
+
+/*****************************************************************************
+** build_match_index()
+**
+** Compile the rule base into one bitset of rules for each value of a
+** nominal attribute and for each region between the interval end points
+** of an ordinal or continuous attribute. An object could have been created
+** by the rules in the AND of the sets its attribute-values select.
+*****************************************************************************/
+struct Match_index *build_match_index(struct Generator *gen) {
+   struct Attribute_def	*Data_Dictionary = gen->dictionary ;
+   struct Flat_rules	*flat = gen->flat ;
+   struct Match_index	*mi ;
+   unsigned long	*free_rules ;
+   int			*start, *order ;
+   int			a, e, n, p, t, sets, words ;
+
+   mi = (struct Match_index *)calloc(1, sizeof(struct Match_index)) ;
+   mi->words = words = gen->cnf_rules/WORD_BITS + 1 ;
+   mi->all   = (unsigned long *)calloc(words, sizeof(unsigned long)) ;
+   free_rules = (unsigned long *)calloc(words, sizeof(unsigned long)) ;
+
+   for (n=1; n<=gen->cnf_rules; n++)
+	mi->all[n/WORD_BITS] |= 1UL << (n%WORD_BITS) ;
+
+   /* group the terms by attribute: start[a] .. start[a+1]-1 of order */
+   start = (int *)calloc(gen->attributes+1, sizeof(int)) ;
+   order = (int *)calloc(flat->terms+1, sizeof(int)) ;
+   for (t=0; t<flat->terms; t++) start[flat->attribute[t]+1]++ ;
+   for (a=0; a<gen->attributes; a++) {
+	if (start[a+1]) mi->used++ ;
+	start[a+1] += start[a] ;
+   }
+   for (t=0; t<flat->terms; t++) order[start[flat->attribute[t]]++] = t ;
+   for (a=gen->attributes; a>0; a--) start[a] = start[a-1] ;
+   start[0] = 0 ;
+
+   mi->entry = (struct Attribute_index *)calloc(mi->used+1, sizeof(struct Attribute_index)) ;
+
+   for (a=0, e=0; a<gen->attributes; a++) {
+	struct Attribute_index	*ai = &mi->entry[e] ;
+	int			first = start[a], last = start[a+1] ;
+
+	/* every rule accepts any value of an unreferenced attribute */
+	if (first == last) continue ;
+	e++ ;
+
+	ai->attribute = a ;
+	ai->datatype  = Data_Dictionary[a].datatype ;
+
+	/* the rules which are free over this attribute */
+	for (p=0; p<words; p++) free_rules[p] = ~0UL ;
+	for (p=first; p<last; p++) {
+	   n = flat->rule[order[p]] ;
+	   free_rules[n/WORD_BITS] &= ~(1UL << (n%WORD_BITS)) ;
+	}
+
+	if (ai->datatype == NOMINAL) {
+	   ai->values = (int)Data_Dictionary[a].dom_max ;
+	   sets = 1 + ai->values ;
+	}
+
+	else { /* ORDINAL or CONTINUOUS: collect the interval end points */
+	   ai->points = (float *)calloc(2*(size_t)(unsigned)(last-first), sizeof(float)) ;
+	   for (p=first, n=0; p<last; p++) {
+		ai->points[n++] = flat->low[order[p]] ;
+		ai->points[n++] = flat->high[order[p]] ;
+	   }
+	   qsort(ai->points, n, sizeof(float), compare_float) ;
+
+	   /* keep the distinct points */
+	   for (p=1, ai->values=1; p<n; p++)
+		if (ai->points[p] != ai->points[ai->values-1])
+		   ai->points[ai->values++] = ai->points[p] ;
+
+	   sets = 2*ai->values + 1 ;
+	}
+
+	ai->accept = (unsigned long *)malloc(sets * words * sizeof(unsigned long)) ;
+	if (ai->accept == NULL) {
+		fprintf(stderr, "ERROR: out of memory for the match index of [%s]\n",
+			Data_Dictionary[a].name) ;
+		fail(3) ;
+	}
+	for (p=0; p<sets; p++)
+	   memcpy(ai->accept + p*words, free_rules, words * sizeof(unsigned long)) ;
+
+	/* add each rule to the sets its term accepts */
+	for (p=first; p<last; p++) {
+	   unsigned long	bit ;
+	   int			low, high, k ;
+
+	   t = order[p] ;
+	   n = flat->rule[t] ;
+	   bit = 1UL << (n%WORD_BITS) ;
+
+	   if (ai->datatype == NOMINAL) {
+		for (k=0; k<flat->set_size[t]; k++)
+		   ai->accept[flat->values[flat->set_first[t]+k]*words + n/WORD_BITS] |= bit ;
+	   }
+	   else {
+		low  = match_set(ai, flat->low[t], words) - ai->accept ;
+		high = match_set(ai, flat->high[t], words) - ai->accept ;
+		for (k=low; k<=high; k+=words)
+		   ai->accept[k + n/WORD_BITS] |= bit ;
+	   }
+	}
+
+	if (debug) fprintf(stderr,
+		"debug: match index of attribute [%s] has %d sets of %d words\n",
+		Data_Dictionary[a].name, sets, words) ;
+   }
+
+   free(start) ;
+   free(order) ;
+   free(free_rules) ;
+   return(mi) ;
+}
+
+
+/*************************************
+** Return rule n's term over attribute a.
+*************************************/
+struct Terms *rule_term(int n, int a) {
+   struct Terms *Term ;
+
+   for (Term=Rules[n].body; Term != NULL; Term=Term->next_term)
+	if (Term->attribute == a) break ;
+   return(Term) ;
+}
+
+
+/*****************************************************************************
+** match_set()
+**
+** Return the bitset of the rules accepting this value of the attribute.
+** Interval regions are found by binary search over the end points.
+*****************************************************************************/
+unsigned long *match_set(struct Attribute_index *ai, float value, int words) {
+   int	low, high, middle ;
+
+   if (ai->datatype == NOMINAL) {
+	int v = (int)value ;
+
+	if (v < 1 || v > ai->values) v = 0 ; /* e.g. MISSINGVAL */
+	return(ai->accept + v*words) ;
+   }
+
+   /* count the end points below the value */
+   low = 0 ; high = ai->values ;
+   while (low < high) {
+	middle = (low + high) / 2 ;
+	if (ai->points[middle] < value) low = middle + 1 ;
+	else high = middle ;
+   }
+
+   if (low < ai->values && ai->points[low] == value)
+	return(ai->accept + (2*low+1)*words) ;
+   return(ai->accept + 2*low*words) ;
+}
+
+
+/*****************************************************************************
+** match_conflict()
+**
+** Return a rule other than j (and the default rule) that could have
+** created the object, or 0 when there is none. sets is scratch space
+** for one bitset pointer per indexed attribute.
+*****************************************************************************/
+int match_conflict(struct Match_index *mi, unsigned long **sets,
+		object new_object, int j) {
+   unsigned long	candidates ;
+   int			e, w, n ;
+
+   for (e=0; e<mi->used; e++)
+	sets[e] = match_set(&mi->entry[e], new_object[mi->entry[e].attribute], mi->words) ;
+
+   for (w=0; w<mi->words; w++) {
+	candidates = mi->all[w] ;
+	if (w == j/WORD_BITS) candidates &= ~(1UL << (j%WORD_BITS)) ;
+
+	for (e=0; e<mi->used && candidates; e++)
+	   candidates &= sets[e][w] ;
+
+	if (candidates) {
+	   for (n=w*WORD_BITS; ! (candidates & 1UL); n++) candidates >>= 1 ;
+	   return(n) ;
+	}
+   }
+
+   return(0) ;
+}
+
+
+
+/*****************************************************************
+******************************************************************
+** OBJECT PROCEDURES						**
+******************************************************************
+*****************************************************************/
+
+/*****************************************************************************
+** create_object()
+**
+** Select a rule for object i and draw attribute-values until no other
+** rule could have created the object. Returns the selected rule.
+** All draws come from the worker's stream.
+*****************************************************************************/
+int create_object(struct Worker *w, long i, object new_object) {
+
+   struct Generator	*gen = w->gen ;
+   struct Rand_stream	*rs  = &w->stream ;
+   struct Flat_rules	*flat = gen->flat ;
+   int		attributes   = gen->attributes ;
+   int		cnf_rules    = gen->cnf_rules ;
+   int		rule_distr   = gen->rule_distr ;
+   float	default_rule = gen->default_rule ;
+   int		New_object_ok=0 ; /* assume not okay */
+   long		retry=0 ;	/* attempts made at this object */
+   long		limit ;		/* objects the failures are measured against */
+   long		failures ;	/* objects rejected before this one */
+   int		j=0, k, n, t, e ;
+
+	/* in counter mode object i starts its own stream */
+	rand_seek(rs, i, retry) ;
+
+	/******************
+	** Select a Rule **
+	******************/
+
+	/* First, is there a default rule? */
+	if (n_rand_r(rs) < default_rule) {
+	   j = 0 ; /* 0 is the default */
+	   if(debug)
+		   fprintf(stderr, "DEBUG: use default rule [%d].\n", j) ;
+	}
+	/* select a rule from the rule base*/
+	else {
+	   if (rule_distr == UNIFORM_DISTRIBUTION ) {
+	        if(debug) fprintf(stderr, "DEBUG: rule [%d] (uniform distribution).\n", j) ;
+			j =  cnf_rules ? 1 + (int)(i % cnf_rules) : 0 ;
+		}
+
+	   else if (rule_distr == RANDOM_DISTRIBUTION ) {
+		/* Select a random rule */
+		   j= 1 + int_rand_r(rs, cnf_rules) ;
+		   if(debug) fprintf(stderr, "DEBUG: rule [%d] (rand distribution).\n", j) ;
+		}
+
+	   else /* Select a random rule with bias*/ {
+		   j= 1 + (int)(cnf_rules*sn_rand_r(rs)) ;
+		   if(debug) fprintf(stderr, "DEBUG: rule [%d] (biased rand distribution).\n", j) ;
+		}
+	}
+
+	/* Without rules (-R0) only the default rule is left */
+	if (j > cnf_rules) j = 0 ;
+
+	/* while a valid object for this rules has not been created */
+	while (New_object_ok==0) {
+
+	/* each retry of object i gets a fresh counter-based stream */
+	if (retry > 0) rand_seek(rs, i, retry) ;
+
+	/************************************************
+	** Create an object which abides by this rule. **
+	************************************************/
+	t = flat->first[j] ;
+	if (gen->deferred) {
+	   /* Only the attributes which some rule tests can make the */
+	   /* object fail. The rest are drawn once it is accepted.   */
+	   for (e=0; e<gen->index->used; e++) {
+		k = gen->index->entry[e].attribute ;
+		if (t < flat->first[j+1] && flat->attribute[t] == k)
+		   draw_value(gen, rs, new_object, k, t++) ;
+		else
+		   draw_value(gen, rs, new_object, k, -1) ;
+	   }
+	}
+
+	else for (k=0; k<attributes; k++) {
+
+	    /* Is this attribute represented in this rule? */
+	    /* (a rule's terms are in attribute order)    */
+	    if (t < flat->first[j+1] && flat->attribute[t] == k)
+		draw_value(gen, rs, new_object, k, t++) ;
+	    else /* Not covered by a rule so randomly choose a value */
+		draw_value(gen, rs, new_object, k, -1) ;
+
+	} /* create each object's attribute */
+
+
+	/*******************************************************************
+	** Test that this new tuple could not be created by another rule. **
+	** The match index holds the rules accepting each attribute-value **
+	*******************************************************************/
+	n = match_conflict(gen->index, w->match_sets, new_object, j) ;
+	New_object_ok = (n == 0) ;
+
+	if (debug && n) fprintf(stderr,
+		"WARN: Bad new object #%ld matches rule %d!\n", i+1, n) ;
+
+
+	if (debug) {
+		int l ;
+		for (l=0;l<attributes;l++)
+			fprintf(stderr,"%d[%g] ", l, new_object[l]) ;
+		fprintf(stderr,"\n") ;
+	}
+		
+
+
+	/* This object could have been created by another rule */
+	if (! New_object_ok) {
+
+	    retry++ ;
+
+    /* a stream, or a few objects deep in the data set, get some slack */
+    limit = gen->objects ;
+    if (gen->endless) limit = i + OBJECTS_PER_CHUNK ;
+    else if (gen->first) limit += OBJECTS_PER_CHUNK ;
+
+    /* one budget for the whole run: -j must not multiply the retries */
+    if (w->queue != NULL) {
+        pthread_mutex_lock(&w->queue->lock) ;
+        failures = w->queue->failures++ ;
+        pthread_mutex_unlock(&w->queue->lock) ;
+    }
+    else failures = w->failures++ ;
+
+    if (failures > FAILURES_PER_OBJECT * limit) {
+        /* FAIL: Recreation of this object has occurred too often */
+	    if (! gen->quiet) {
+		fprintf(stderr, 
+			"\nEXCEPTION:\n\tFailed to create all the requested objects.\n") ;
+		fprintf(stderr, 
+			"\tThis domain appears to be too constrained!\n\n") ;
+	    }
+		fail(1) ;
+    }
+	}
+
+    } /* while an object for this rule has not been created */
+
+    /* -l: fill in the attributes which no rule tests */
+    if (gen->deferred)
+	for (k=0, e=0; k<attributes; k++) {
+	   if (e < gen->index->used && gen->index->entry[e].attribute == k) e++ ;
+	   else draw_value(gen, rs, new_object, k, -1) ;
+	}
+
+    return(j) ;
+}
+
+
+/*****************************************************************************
+** draw_value()
+**
+** Draw attribute k of an object from term t of the flat rule base, or
+** from the attribute's whole domain when t is -1, then perhaps make it a
+** missing value.
+*****************************************************************************/
+void draw_value(struct Generator *gen, struct Rand_stream *rs, object new_object,
+		int k, int t) {
+
+   struct Attribute_def *Data_Dictionary = gen->dictionary ;
+   struct Flat_rules	*flat = gen->flat ;
+
+	if (t >= 0) { /* Pick a value from the rule's term */
+
+		if (flat->datatype[t] == NOMINAL) {
+			new_object[k] = (float)flat->values[flat->set_first[t]
+				+ int_rand_r(rs, flat->set_size[t])] ;
+		}
+		else if (flat->datatype[t] == ORDINAL) {
+			int low = (int)flat->low[t] ;
+
+			new_object[k] = (float)(low + 
+				int_rand_r(rs, 1 + (int)flat->high[t] - low)) ;
+				/* added +1 to include the max value */
+		}
+		else if (flat->datatype[t] == CONTINUOUS) {
+			new_object[k] = (float)(flat->low[t] + 
+				(n_rand_r(rs)*(flat->high[t]-flat->low[t])) ) ;
+		}
+		else {
+		   fprintf(stderr, "\nERROR 19274494.\n") ;
+		   fail(3) ;
+		}
+	}
+
+	else { /* Not covered by the rule so randomly choose a value */
+
+		if (debug) fprintf(stderr, " randval[%d] ", k) ;
+
+		if (Data_Dictionary[k].datatype == NOMINAL) {
+			int random_nominal = 1 + int_rand_r(rs, (int)Data_Dictionary[k].dom_max) ;
+
+			new_object[k] = (float)random_nominal ;
 			if (debug) fprintf(stderr, " nom[%d] ", random_nominal) ;
 
-		}
-		else if (Data_Dictionary[k].datatype == ORDINAL) {
-			int random_ordinal ;
+		}
+		else if (Data_Dictionary[k].datatype == ORDINAL) {
+			int random_ordinal ;
+
+			/* add +1 to include the dom_max value */
+			random_ordinal = int_rand_r(rs, (int)(1 + Data_Dictionary[k].dom_max-Data_Dictionary[k].dom_min)) ;
+			random_ordinal += (int)Data_Dictionary[k].dom_min ;
+
+			new_object[k] = (float)random_ordinal ;
+			if (debug) fprintf(stderr, " ord[%d] ", random_ordinal) ;
+		}
+		else if (Data_Dictionary[k].datatype == CONTINUOUS) {
+
+			new_object[k] =
+				(float)Data_Dictionary[k].dom_min + (float)n_rand_r(rs) *
+				(Data_Dictionary[k].dom_max - Data_Dictionary[k].dom_min) ;
+
+		}
+		else {
+			   fprintf(stderr, "\nERROR 294489473.\n") ;
+			   fail(3) ;
+		}
+	}
+
+	/* This may be a missing attribute-value */
+	/* If so then reset value to MISSINGVAL */
+	if ( gen->miss_ratio > n_rand_r(rs) ) {
+		new_object[k] = MISSINGVAL ;
+	}
+}
+
+
+/*****************************************************************************
+** add_noise()
+**
+** Overwrite erroneously entered attribute-values of an object created by
+** rule j, flagging them in erroneous[], and return its (possibly
+** erroneous) class. The draws come from the stream rs.
+*****************************************************************************/
+int add_noise(struct Generator *gen, int j, object new_object, char *erroneous,
+		struct Rand_stream *rs) {
+
+   struct Attribute_def *Data_Dictionary = gen->dictionary ;
+   int		attributes   = gen->attributes ;
+   float	attrib_error = gen->attrib_error ;
+   int		class = gen->rules[j].tail ;
+   int		k ;
+
+	  for (k=0; k<attributes; k++) {
+
+		erroneous[k] = 0 ;
+
+		/* This attribute is masked */
+		if (Data_Dictionary[k].masked) continue ;
+
+		/* supply a rule-independent (erroneously entered) attribute-value */
+		if ( attrib_error > n_rand_r(rs) ) {
+
+		  erroneous[k] = 1 ;
+
+		  if (Data_Dictionary[k].datatype == NOMINAL) {
+			new_object[k] = (float)(1 + int_rand_r(rs, (int)Data_Dictionary[k].dom_max)) ;
+		  }
+
+		  else if (Data_Dictionary[k].datatype == ORDINAL) {
+			new_object[k] = (float)((int)Data_Dictionary[k].dom_min
+						+ int_rand_r(rs, (int)Data_Dictionary[k].dom_max - (int)Data_Dictionary[k].dom_min)) ;
+		  }
+
+		  else if (Data_Dictionary[k].datatype == CONTINUOUS) {
+			new_object[k] = Data_Dictionary[k].dom_min + (float)(n_rand_r(rs) *
+				(Data_Dictionary[k].dom_max - Data_Dictionary[k].dom_min)) ;
+		  }
+
+		  else {
+			fprintf(stderr, "\nERROR 294489473.\n") ;
+			fail(2) ;
+		  }
+		}
+	  }
+
+	  /* erroneously entered class */
+	  if ( gen->class_error > n_rand_r(rs) )
+		class = int_rand_r(rs, gen->classes+1) ; /* overwrite the correct class */
+
+	  return(class) ;
+}
+
+
+/*****************************************************************************
+** format_object()
+**
+** Append object i, with the given class, as one line of text to ob.
+*****************************************************************************/
+void format_object(struct Generator *gen, long i, object new_object, char *erroneous,
+		int class, struct Out_buffer *ob) {
+
+   struct Attribute_def *Data_Dictionary = gen->dictionary ;
+   int		attributes   = gen->attributes ;
+   int		k ;
+
+	  /* Display the object id */
+	  if(verbose) out_printf(ob, "%5ld:\t\t", i+1) ;
+
+	  /* Cycle through each attribute */
+	  for (k=0; k<attributes; k++) {
+
+		if (debug) out_printf(ob, "%d|", k) ;
+
+		/* This attribute is masked */
+		if (Data_Dictionary[k].masked) {
+		    if (verbose) out_printf(ob, "   *\t" ) ;
+		}
+
+		/* a rule-independent (erroneously entered) attribute-value */
+		else if (erroneous[k]) {
+		  if (debug) out_printf(ob, "er[%d] ", 
+			  Data_Dictionary[k].datatype) ;
+
+		  if (Data_Dictionary[k].datatype == NOMINAL) {
+			int rand_val = (int)new_object[k] ;
+
+			if (verbose)	out_printf(ob, "%4s*\t", LABEL(rand_val) ) ;
+			else			out_text(ob, LABEL(rand_val), LABEL_LENGTH(rand_val), '\t') ;
+		  }
+
+		  else if (Data_Dictionary[k].datatype == ORDINAL) {
+			int rand_val = (int)new_object[k] ;
+
+			if (verbose)	out_printf(ob, "%4d*\t", rand_val ) ;
+			else			out_int(ob, rand_val, '\t') ;
+		  }
+
+		  else {
+			float rand_val = new_object[k] ;
+
+			if (verbose)	out_printf(ob, "%5.2g*\t", rand_val ) ;
+			else			out_printf(ob, "%5.2g\t" , rand_val ) ;
+		  }
+		
+		} /* an erroneously entered value */
+
+
+		/* missing attribute-value */
+		else if (new_object[k] == MISSINGVAL) {
+		  if (debug) out_printf(ob, "mi[%d] ", 
+			  Data_Dictionary[k].datatype) ;
+
+		  if (verbose)
+			out_printf(ob, "%4s\t", MISSINGVALCHAR ) ;
+		  
+		  else
+			out_text(ob, MISSINGVALCHAR, (int)strlen(MISSINGVALCHAR), '\t') ;
+		}
+
+		/* all hurdles were passed */
+		else {
+
+			if (debug) out_printf(ob, "ok[%d] ",
+				Data_Dictionary[k].datatype) ;
+
+			if (Data_Dictionary[k].datatype == NOMINAL) {
+				int value = (int)new_object[k] ;
+
+				if (verbose) {
+					out_printf(ob, "%4s\t", LABEL(value) ) ;
+				}
+
+				else {
+					out_text(ob, LABEL(value), LABEL_LENGTH(value), '\t') ;
+			    }
+			}
+
+		
+			else if (Data_Dictionary[k].datatype == ORDINAL) {	
+				if (verbose) {
+					out_printf(ob, "%4d\t", (int)new_object[k] ) ;
+				}
+				else {
+					out_int(ob, (long)new_object[k], '\t') ;
+				}
+			}
+	    
+			else if (Data_Dictionary[k].datatype == CONTINUOUS) {	
+				if (verbose) {
+					out_printf(ob, "%5.2g\t", new_object[k] ) ;
+				}
+				else {
+					out_float(ob, new_object[k], '\t') ;
+				}
+			}
+			else { /* ERROR */
+					fprintf(stderr, "ERROR: unknown condition 9359732 [%d].\n",
+						Data_Dictionary[k].datatype) ;
+					fail(3) ;
+			}
+
+	    
+		} /* Printed this attribute's value */
+
+		} /* Cycled through the attributes */
+
+
+	    /* Finally, report the class value */
+		if (verbose)
+			out_printf(ob, "%5s%d\n", "c", class ) ;
+		else {
+			out_text(ob, "c", 1, 0) ;
+			out_int(ob, class, '\n') ;
+		}
+}
+
+/*****************************************************************************
+** format_banner()
+**
+** Append the plain banner of -c, the names of the visible attributes and
+** the class, to ob.
+*****************************************************************************/
+void format_banner(struct Generator *gen, struct Out_buffer *ob) {
+   int	k ;
+
+	for (k=0; k<gen->attributes; k++)
+	    if ( !(gen->dictionary[k].masked) )
+		out_text(ob, gen->dictionary[k].name, (int)strlen(gen->dictionary[k].name), '\t') ;
+
+	out_text(ob, class_name, (int)strlen(class_name), '\n') ;
+}
+
+/*****************************************************************************
+** format_sparse()
+**
+** Append an object, with the given class, to ob as one sparse line:
+**
+**   -t libsvm   class index:value ...	indices 1.. of the visible
+**					attributes; zero and missing
+**					values are left out
+**   -t arff     {index value, ...}	indices 0..; zero values and the
+**					first label of a nominal attribute
+**					are left out, missing values are ?
+**
+** Nominal values are written as their value number 1..dom_max in LibSVM
+** and as their label in ARFF.
+*****************************************************************************/
+void format_sparse(struct Generator *gen, object new_object, int class, struct Out_buffer *ob) {
+   struct Attribute_def *Data_Dictionary = gen->dictionary ;
+   int		libsvm = gen->format == OUT_LIBSVM ;
+   char		end = libsvm ? ' ' : ',' ;	/* follows every value */
+   int		k, n ;
+   float	x ;
+
+   if (libsvm) out_int(ob, (long)class, end) ;
+   else out_text(ob, "{", 1, 0) ;
+
+   for (k=0, n=0; k<gen->attributes; k++) {
+
+	if (Data_Dictionary[k].masked) continue ;
+	x = new_object[k] ;
+	n++ ;
+
+	if (x == MISSINGVAL) {
+	   if (libsvm) continue ;
+	   out_int(ob, (long)(n-1), ' ') ;
+	   out_text(ob, MISSINGVALCHAR, (int)strlen(MISSINGVALCHAR), end) ;
+	}
+
+	else if (Data_Dictionary[k].datatype == NOMINAL) {
+	   if (libsvm) {
+		out_int(ob, (long)n, ':') ;
+		out_int(ob, (long)x, end) ;
+	   }
+	   else if (x != 1) {		/* the first label is left out */
+		out_int(ob, (long)(n-1), ' ') ;
+		out_text(ob, LABEL((int)x), LABEL_LENGTH((int)x), end) ;
+	   }
+	}
+
+	else if (x != 0) {
+	   out_int(ob, (long)(libsvm ? n : n-1), libsvm ? ':' : ' ') ;
+	   if (Data_Dictionary[k].datatype == ORDINAL) out_int(ob, (long)x, end) ;
+	   else out_float(ob, x, end) ;
+	}
+   }
+
+   /* the last value ends the line; ARFF always ends with the class */
+   if (libsvm) ob->text[ob->length - 1] = '\n' ;
+   else {
+	out_int(ob, (long)n, ' ') ;
+	out_text(ob, "c", 1, 0) ;
+	out_int(ob, (long)class, '}') ;
+	out_text(ob, "", 0, '\n') ;
+   }
+}
+
+
+/*****************************************************************************
+** format_arff_header()
+**
+** Append the ARFF header of the visible attributes and the class to ob.
+** NOMINAL attributes list their labels, ORDINAL ones are INTEGER and
+** CONTINUOUS ones REAL.
+*****************************************************************************/
+void format_arff_header(struct Generator *gen, struct Out_buffer *ob) {
+   struct Attribute_def *Data_Dictionary = gen->dictionary ;
+   int		k, v ;
+
+   out_printf(ob, "@RELATION datgen\n\n") ;
+
+   for (k=0; k<gen->attributes; k++) {
+	if (Data_Dictionary[k].masked) continue ;
+
+	out_printf(ob, "@ATTRIBUTE %s ", Data_Dictionary[k].name) ;
+	if (Data_Dictionary[k].datatype == NOMINAL) {
+	   out_text(ob, "{", 1, 0) ;
+	   for (v=1; v<=(int)Data_Dictionary[k].dom_max; v++) {
+		if (v > 1) out_text(ob, ",", 1, 0) ;
+		out_text(ob, LABEL(v), LABEL_LENGTH(v), 0) ;
+	   }
+	   out_text(ob, "}", 1, 0) ;
+	}
+	else if (Data_Dictionary[k].datatype == ORDINAL) out_printf(ob, "INTEGER") ;
+	else out_printf(ob, "REAL") ;
+	out_text(ob, "", 0, '\n') ;
+   }
+
+   out_printf(ob, "@ATTRIBUTE '%s' {", class_name) ;
+   for (v=0; v<=gen->classes; v++)
+	out_printf(ob, "c%d%s", v, v < gen->classes ? "," : "}\n") ;
+
+   out_printf(ob, "\n@DATA\n") ;
+}
+
+
+/*****************************************************************************
+** object_worker()
+**
+** Repeatedly take the next chunk of objects, create it into a private
+** buffer, and wait for the chunk's turn to be written to stdout.
+*****************************************************************************/
+void *object_worker(void *arg) {
+   struct Worker	*w = (struct Worker *)arg ;
+   struct Chunk_queue	*q = w->queue ;
+   struct Generator	*gen = w->gen ;
+   object		new_object ;
+   char			*erroneous ;	/* flag per attribute */
+   long			chunk, first, last, i ;
+   long			body_length = 0, c, offset ;
+   int			j, class, meta_length = 0, code ;
+   jmp_buf		env ;
+   void			*caller = NULL ;
+
+   new_object = (object)malloc((gen->attributes+1) * sizeof(float)) ;
+   erroneous  = (char *)malloc((size_t)gen->attributes+1) ;
+
+   /* fail() ends the run for all the workers and comes back here */
+   if (q->caught) {
+	caller = pthread_getspecific(failure_key) ;
+	if ((code = setjmp(env)) != 0) {
+	    pthread_setspecific(failure_key, caller) ;
+	    pthread_mutex_lock(&q->lock) ;
+	    if (q->failed == 0) q->failed = code ;
+	    pthread_cond_broadcast(&q->turn) ;
+	    pthread_mutex_unlock(&q->lock) ;
+	    free(new_object) ;
+	    free(erroneous) ;
+	    return(NULL) ;
+	}
+	pthread_setspecific(failure_key, &env) ;
+   }
+
+   for (;;) {
+
+	/* claim the next chunk */
+	pthread_mutex_lock(&q->lock) ;
+	count_rules(w) ;
+	if (report_requested) {
+	    report_requested = 0 ;
+	    dump_rules(gen) ;
+	}
+
+	/* a stream ends after the chunks already handed out, a failed run
+	   at once */
+	if ((stop_requested || q->failed || (gen->seconds > 0 && clock_seconds() - q->start >= gen->seconds))
+		&& q->chunks > q->next_chunk)
+	    q->chunks = q->next_chunk ;
+
+	/* q->chunks shrinks under the lock, so test the claim there too */
+	chunk = q->next_chunk++ ;
+	if (chunk >= q->chunks) {
+	    pthread_mutex_unlock(&q->lock) ;
+	    break ;
+	}
+	pthread_mutex_unlock(&q->lock) ;
+
+	first = chunk * q->per_chunk ;
+	last  = first + q->per_chunk ;
+	if (last > gen->objects && ! gen->endless) last = gen->objects ;
+
+	w->out.length = 0 ;
+	w->batch.rows = 0 ;
+	for (i=first; i<last; i++) {
+	    j = create_object(w, gen->first + i, new_object) ;
+	    w->rule_objects[j]++ ;
+	    class = add_noise(gen, j, new_object, erroneous, &w->stream) ;
+
+	    if (gen->format == OUT_TSV)
+		format_object(gen, gen->first + i, new_object, erroneous, class, &w->out) ;
+	    else if (TEXT_FORMAT(gen->format))
+		format_sparse(gen, new_object, class, &w->out) ;
+	    else {
+		memcpy(w->batch.values + w->batch.rows * gen->attributes, new_object,
+			gen->attributes * sizeof(float)) ;
+		w->batch.class[w->batch.rows++] = class ;
+	    }
+	}
+
+	/* column files and records are written in place, in any order */
+	if (gen->format == OUT_NPY) {
+	    npy_chunk(gen, &w->batch, first, &w->fb) ;
+	    continue ;
+	}
+	if (gen->format == OUT_ROWS) {
+	    rows_chunk(gen, &w->batch, first, &w->out) ;
+	    continue ;
+	}
+
+	/* a chunk is one record batch or row group */
+	if (gen->format == OUT_PARQUET)
+	    parquet_row_group(gen, &w->batch, &w->fb, &w->out, &w->columns) ;
+	else if (! TEXT_FORMAT(gen->format))
+	    arrow_record_batch(gen, &w->batch, &w->fb, &w->out, &meta_length, &body_length) ;
+
+	/* each chunk is a gzip member of its own */
+	if (gen->compress)
+	    out_compress(&w->out, &w->packed, gen->compress) ;
+
+	/* chunks are written in order */
+	pthread_mutex_lock(&q->lock) ;
+	while (q->next_write != chunk && ! q->failed)
+		pthread_cond_wait(&q->turn, &q->lock) ;
+	if (q->failed) {
+		pthread_mutex_unlock(&q->lock) ;
+		break ;
+	}
+	if (gen->rate > 0)
+		take_tokens(q, gen->rate, gen->rate_bytes ? (double)w->out.length : (double)(last - first)) ;
+	if (gen->format == OUT_ARROW)
+		add_block(&q->batches, q->written, meta_length, body_length) ;
+	for (c=0; c<w->columns.blocks; c++)
+		add_block(&q->batches, q->written + w->columns.block[3*c],
+			(int)w->columns.block[3*c + 1], w->columns.block[3*c + 2]) ;
+	offset = q->written ;
+	q->written += w->out.length ;
+
+	/* a file takes the next chunk while this one is being written */
+	if (gen->path) {
+	    out_allocate(q, chunk) ;
+	    q->next_write++ ;
+	    pthread_cond_broadcast(&q->turn) ;
+	}
+	pthread_mutex_unlock(&q->lock) ;
+
+	if (gen->path) {
+	    out_pwrite(&w->out, offset) ;
+	    continue ;
+	}
+
+	out_write(&w->out) ;
+
+	pthread_mutex_lock(&q->lock) ;
+	q->next_write++ ;
+	pthread_cond_broadcast(&q->turn) ;
+	pthread_mutex_unlock(&q->lock) ;
+   }
+
+   pthread_mutex_lock(&q->lock) ;
+   count_rules(w) ;
+   pthread_mutex_unlock(&q->lock) ;
+
+   if (q->caught) pthread_setspecific(failure_key, caller) ;
+   free(new_object) ;
+   free(erroneous) ;
+   return(NULL) ;
+}
+
+
+/*****************************************************************************
+** create_objects()
+**
+** Create and print all of the objects with the given number of threads.
+** A single job runs in the calling thread. Each worker counts the objects
+** of every rule on its own and adds the counts to the rule base whenever
+** it claims a chunk, so a stream can report them while it runs.
+** When the caller catches fail() (libdatgen, the server) a failing worker
+** stops the run, and fail() is called again here once it is cleaned up.
+*****************************************************************************/
+void create_objects(struct Generator *gen, int jobs) {
+   struct Chunk_queue	queue ;
+   struct Worker	*workers ;
+   int			w ;
+
+   /* wide rows are handed out a few at a time */
+   queue.per_chunk  = FIELDS_PER_CHUNK / (gen->attributes+2) ;
+   if (queue.per_chunk > OBJECTS_PER_CHUNK) queue.per_chunk = OBJECTS_PER_CHUNK ;
+   if (queue.per_chunk < 1) queue.per_chunk = 1 ;
+
+   /* -L: chunks of about a hundredth of a second keep the rate even */
+   if (gen->rate > 0) {
+	double	pace = gen->rate / 100 ;
+
+	if (gen->rate_bytes) pace /= (gen->attributes+2) * 4 ;
+	if (queue.per_chunk > pace) queue.per_chunk = pace < 1 ? 1 : (long)pace ;
+   }
+
+   queue.chunks     = gen->endless ? LONG_MAX : (gen->objects + queue.per_chunk - 1) / queue.per_chunk ;
+   queue.next_chunk = 0 ;
+   queue.next_write = 0 ;
+   queue.written    = 0 ;
+   queue.allocated  = 0 ;
+   queue.start      = clock_seconds() ;
+   queue.tokens     = 0 ;
+   queue.refilled   = queue.start ;
+   queue.failures   = 0 ;
+   queue.caught     = failure_keyed && pthread_getspecific(failure_key) != NULL ;
+   queue.failed     = 0 ;
+   queue.dictionaries.blocks = queue.batches.blocks = 0 ;
+   queue.dictionaries.size   = queue.batches.size   = 0 ;
+   queue.dictionaries.block  = queue.batches.block  = NULL ;
+   pthread_mutex_init(&queue.lock, NULL) ;
+   pthread_cond_init(&queue.turn, NULL) ;
+
+   workers = (struct Worker *)calloc(jobs, sizeof(struct Worker)) ;
+   for (w=0; w<jobs; w++) {
+	workers[w].gen          = gen ;
+	workers[w].queue        = &queue ;
+	workers[w].stream       = gen->stream ;
+	workers[w].rule_objects = (int *)calloc(gen->cnf_rules+1, sizeof(int)) ;
+	workers[w].failures     = 0 ;
+	workers[w].match_sets   = (unsigned long **)calloc(gen->index->used+1, sizeof(unsigned long *)) ;
+	workers[w].out.size     = queue.per_chunk * (long)(gen->attributes+2) * 4 + OUT_FIELD_MAX ;
+	workers[w].out.text     = (char *)malloc((size_t)workers[w].out.size) ;
+	workers[w].out.length   = 0 ;
+	if (! TEXT_FORMAT(gen->format)) {
+	   workers[w].batch.values = (float *)malloc(queue.per_chunk * gen->attributes * sizeof(float)) ;
+	   workers[w].batch.class  = (int *)malloc(queue.per_chunk * sizeof(int)) ;
+	   workers[w].batch.codes  = (int *)malloc(queue.per_chunk * sizeof(int)) ;
+	   workers[w].fb.size      = 4096 ;
+	   workers[w].fb.text      = (char *)malloc((size_t)workers[w].fb.size) ;
+	   workers[w].fb.length    = 0 ;
+	}
+   }
+
+   /* -o: the objects go to a file (-t npy makes a directory of them) */
+   if (gen->path && gen->format != OUT_NPY) {
+	output_fd = open(gen->path, O_WRONLY | O_CREAT | O_TRUNC, 0666) ;
+	if (output_fd < 0) {
+		fprintf(stderr, "ERROR: could not open the output file %s\n", gen->path) ;
+		fail(3) ;
+	}
+   }
+
+   if ((gen->format == OUT_TSV && gen->banner) || gen->format == OUT_ARFF) {
+	if (gen->format == OUT_ARFF) format_arff_header(gen, &workers[0].out) ;
+	else format_banner(gen, &workers[0].out) ;
+	if (gen->compress) out_compress(&workers[0].out, &workers[0].packed, gen->compress) ;
+	queue.written += workers[0].out.length ;
+	out_write(&workers[0].out) ;
+   }
+   else if (gen->format == OUT_PARQUET) {
+	out_text(&workers[0].out, "PAR1", 4, 0) ;
+	queue.written += workers[0].out.length ;
+	out_write(&workers[0].out) ;
+   }
+   else if (gen->format == OUT_NPY) npy_begin(gen) ;
+   else if (gen->format == OUT_ROWS) rows_begin(gen, &queue) ;
+   else if (! TEXT_FORMAT(gen->format)) arrow_begin(gen, &queue) ;
+
+   if (jobs == 1)
+	object_worker(&workers[0]) ;
+
+   else {
+	for (w=0; w<jobs; w++)
+	   if (pthread_create(&workers[w].thread, NULL, object_worker, &workers[w])) {
+		fprintf(stderr, "ERROR: could not create thread %d\n", w) ;
+		fail(3) ;
+	   }
+	for (w=0; w<jobs; w++)
+	   pthread_join(workers[w].thread, NULL) ;
+   }
+
+   /* a failed run only closes what it opened */
+   if (queue.failed) {
+	if (gen->format == OUT_NPY)
+	   for (w=0; w<=gen->attributes; w++)
+		if (gen->columns[w] >= 0) close(gen->columns[w]) ;
+	if (gen->format == OUT_NPY || gen->format == OUT_ROWS) free(gen->columns) ;
+	if (gen->path && gen->format != OUT_NPY) {
+	   close(output_fd) ;
+	   output_fd = 1 ;
+	}
+   }
+
+   else {
+	/* what follows the chunks goes after the last of them */
+	if (gen->path && gen->format != OUT_NPY)
+	   lseek(output_fd, (off_t)queue.written, SEEK_SET) ;
+
+	if (gen->format == OUT_PARQUET) parquet_end(gen, &queue) ;
+	else if (gen->format == OUT_NPY) npy_end(gen) ;
+	else if (gen->format == OUT_ROWS) free(gen->columns) ;
+	else if (! TEXT_FORMAT(gen->format)) arrow_end(gen, &queue) ;
+
+	/* give back what was preallocated past the end */
+	if (gen->path && gen->format != OUT_NPY) {
+	   if (ftruncate(output_fd, lseek(output_fd, (off_t)0, SEEK_CUR)) != 0
+		|| close(output_fd) != 0) {
+		perror("ERROR: closing the output file") ;
+		fail(3) ;
+	   }
+	   output_fd = 1 ;
+	}
+   }
+
+   fflush(stdout) ;
+
+   for (w=0; w<jobs; w++) {
+	free(workers[w].rule_objects) ;
+	free(workers[w].out.text) ;
+	free(workers[w].match_sets) ;
+	free(workers[w].batch.values) ;
+	free(workers[w].batch.class) ;
+	free(workers[w].batch.codes) ;
+	free(workers[w].columns.block) ;
+	free(workers[w].fb.text) ;
+	free(workers[w].packed.text) ;
+   }
+   free(workers) ;
+   free(queue.dictionaries.block) ;
+   free(queue.batches.block) ;
+
+   pthread_mutex_destroy(&queue.lock) ;
+   pthread_cond_destroy(&queue.turn) ;
+
+   if (queue.failed) fail(queue.failed) ;
+}
+
+/*****************************************************************************
+** create_parts()
+**
+** Split the run into parts of per_part objects, each written to a file
+** part-NNNNN of the directory gen->path by create_objects() with all the
+** threads. Part p holds objects gen->first + p*per_part on, exactly as
+** the single run would have created them. manifest.json lists the parts
+** and the objects created by each rule over all of them. The parts of an
+** earlier run in the directory are removed first.
+*****************************************************************************/
+void create_parts(struct Generator *gen, int jobs, long per_part) {
+   char		*directory = gen->path ;
+   char		*extension ;
+   char		*file ;
+   long		objects = gen->objects ;
+   long		start   = gen->first ;	/* -i */
+   long		parts, p ;
+   int		j ;
+   FILE		*manifest ;
+
+   if (mkdir(directory, 0777) != 0 && errno != EEXIST) {
+	fprintf(stderr, "ERROR: could not create the directory %s\n", directory) ;
+	fail(3) ;
+   }
+   remove_parts(directory, "part-") ;
+
+   /* room for the longest part name and manifest.json */
+   file = (char *)malloc(strlen(directory) + 64) ;
+
+   if (gen->format == OUT_ARROW) extension = ".arrow" ;
+   else if (gen->format == OUT_ARROW_STREAM) extension = ".arrows" ;
+   else if (gen->format == OUT_PARQUET) extension = ".parquet" ;
+   else if (gen->format == OUT_NPY) extension = "" ;	/* a directory */
+   else if (gen->format == OUT_LIBSVM) extension = gen->compress ? ".libsvm.gz" : ".libsvm" ;
+   else if (gen->format == OUT_ARFF) extension = gen->compress ? ".arff.gz" : ".arff" ;
+   else if (gen->format == OUT_ROWS) extension = ".rows" ;
+   else extension = gen->compress ? ".tsv.gz" : ".tsv" ;
+
+   parts = objects ? (objects + per_part - 1) / per_part : 1 ;
+
+   for (p=0; p<parts; p++) {
+	sprintf(file, "%s/part-%05ld%s", directory, p, extension) ;
+	gen->path    = file ;
+	gen->first   = start + p * per_part ;
+	gen->objects = objects - p * per_part < per_part ? objects - p * per_part : per_part ;
+	create_objects(gen, jobs) ;
+   }
+   gen->path    = directory ;
+   gen->first   = start ;
+   gen->objects = objects ;
+
+   sprintf(file, "%s/manifest.json", directory) ;
+   if ((manifest = fopen(file, "w")) == NULL) {
+	fprintf(stderr, "ERROR: could not open %s\n", file) ;
+	fail(3) ;
+   }
+
+   fprintf(manifest, "{\n  \"objects\": %ld,\n  \"parts\": [", objects) ;
+   for (p=0; p<parts; p++) {
+	fprintf(manifest, "%s\n    {\"file\": \"part-%05ld%s\", \"first\": %ld, \"objects\": %ld}",
+		p ? "," : "", p, extension, start + p * per_part,
+		objects - p*per_part < per_part ? objects - p*per_part : per_part) ;
+   }
+
+   fprintf(manifest, "\n  ],\n  \"rules\": [") ;
+   for (j=0; j<=gen->cnf_rules; j++)
+	fprintf(manifest, "%s\n    {\"rule\": %d, \"class\": \"c%d\", \"default\": %s, \"objects\": %ld}",
+		j ? "," : "", j, gen->rules[j].tail, gen->rules[j].default_rule ? "true" : "false",
+		gen->rules[j].objects) ;
+   fprintf(manifest, "\n  ]\n}\n") ;
+
+   if (fclose(manifest) != 0) {
+	fprintf(stderr, "ERROR: could not write %s\n", file) ;
+	fail(3) ;
+   }
+   free(file) ;
+}
+
+
+/*****************************************************************************
+** remove_parts()
+**
+** Remove the entries of directory whose names start with prefix, and
+** the files of those which are directories themselves (-t npy parts),
+** so that a shorter run does not leave parts of a longer one behind.
+*****************************************************************************/
+void remove_parts(char *directory, char *prefix) {
+   DIR			*dir ;
+   struct dirent	*entry ;
+   char			*path ;
+
+   if ((dir = opendir(directory)) == NULL) return ;
+
+   while ((entry = readdir(dir)) != NULL) {
+	if (strncmp(entry->d_name, prefix, strlen(prefix)) != 0
+		|| strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+	    continue ;
+
+	path = (char *)malloc(strlen(directory) + strlen(entry->d_name) + 2) ;
+	sprintf(path, "%s/%s", directory, entry->d_name) ;
+	if (unlink(path) != 0) {
+	    remove_parts(path, "") ;
+	    rmdir(path) ;
+	}
+	free(path) ;
+   }
+   closedir(dir) ;
+}
+
+
+/*****************************************************************************
+** report_rules()
+**
+** Print each rule with the share of the objects it has created so far,
+** the most active first, to stream. Works on a copy of the rule base, so
+** a stream can report while its objects are still being created.
+*****************************************************************************/
+void report_rules(struct Generator *gen, FILE *stream) {
+   struct Attribute_def *Data_Dictionary = gen->dictionary ;
+   struct CNF_Rule	*rules ;
+   int		cnf_rules = gen->cnf_rules ;
+   float	default_rule = gen->default_rule ;
+   long		total ;
+   float	r ;
+   int		i, j, k, firstA, firstB ;
+
+   if (debug) fprintf(stderr, "\nDEBUG: Display Rules {\n");
+
+   rules = (struct CNF_Rule *)malloc((cnf_rules+1) * sizeof(struct CNF_Rule)) ;
+   memcpy(rules, gen->rules, (cnf_rules+1) * sizeof(struct CNF_Rule)) ;
+   for (i=0, total=0; i<=cnf_rules; i++) total += rules[i].objects ;
+
+	/* Sort the rules based on their data set representation */
+	qsort(rules, cnf_rules, sizeof(struct CNF_Rule), compare_rule_freq) ;
+
+	if (verbose) fprintf(stream,
+		"\n\nRULES\n\t(activation%%) class <- class description\n\n");
+
+
+
+	
+
+	
+	
+	
+		/* Report each rule's composition and performance */
+	for (i=0; i<=cnf_rules; i++) {
+	    struct Terms	*Term ;
+
+	  /* if this is not the default rule or if it is the 
+		default rule that a default rule was specified */
+	  if (rules[i].default_rule==0 || default_rule>0.0) {
+
+        /* print rule id */
+	    if (debug) fprintf(stderr, "  Rule %d\n", i);
+
+		/* calculate the rule's activation frequency */
+		r=(float)rules[i].objects ;
+		r/=total ;
+
+	    if (verbose) fprintf(stream, "\t") ;
+	    
+		/* (percent) class <- */
+	    fprintf(stream, "(%02.1f%%) c%d <- ",
+			r*100, rules[i].tail) ;
+
+	    if (rules[i].default_rule==1)
+			fprintf(stream, " default ") ;
+
+		/* for each attribute   used by the rule */
+	    Term=rules[i].body ;
+
+
+	    for (firstA=1; Term != NULL; Term=Term->next_term) {
+		  j = Term->attribute ;
+
+			/* time for an ampersand & */
+			if (firstA) firstA=!firstA ;
+		    else fprintf(stream, " & ") ;
+
+			/* print the attribute's name */
+		    fprintf(stream, "%s", Data_Dictionary[j].name) ;
+
+		    /* show that this was a masked attribute */
+		    if (Data_Dictionary[j].masked) fprintf(stream, "*" ) ;
+
+			if (Data_Dictionary[j].datatype == NOMINAL) {
+				char buffer[256] ;
+				
+				fprintf(stream, "=") ;
+
+				if (debug) fprintf(stream, "%d", Term->setsize);
+
+			    /* add parentheses if this is a disjuntive term */
+			    if (Term->setsize > 1) fprintf(stream, "{") ;
+
+				/* for each value in the term's set */
+			    for (k=0,firstB=1; k<Term->setsize; k++) {
+
+					if (firstB) firstB=!firstB ;
+					else fprintf(stream, "," ) ;
+
+					num2str(Term->nominal[k], buffer) ;
+					fprintf(stream,"%s", buffer ) ;
+				}
+				/* conclude the set if there were several values */
+			    if (Term->setsize > 1) fprintf(stream, "}" ) ;
+			}
+			
+			else if (Data_Dictionary[j].testtype == TWOSIDED) {
+
+			   if (Data_Dictionary[j].datatype == ORDINAL) {
+				if (Term->setsize == 1)
+					fprintf(stream, "=%d", Term->ordinal[0]) ;
+				else
+					fprintf(stream, "=[%d,%d]", Term->ordinal[0], Term->ordinal[1] ) ;
+			   }
+			   else
+						fprintf(stream, "=[%g,%g]", Term->continuous[0], Term->continuous[1] ) ;
+			}
+
+			else if (Data_Dictionary[j].testtype == ONESIDED) {
+
+				if (Term->lessthan) {
+					fprintf(stream, "<=") ;
+					if (Data_Dictionary[j].datatype == ORDINAL)
+						fprintf(stream, "%d", Term->ordinal[1] ) ;
+					else
+						fprintf(stream, "%f", Term->continuous[1] ) ;
+				}
+				else {
+					fprintf(stream, ">=") ;
+					if (Data_Dictionary[j].datatype == ORDINAL)
+						fprintf(stream, "%d", Term->ordinal[0] ) ;
+					else
+						fprintf(stream, "%f", Term->continuous[0] ) ;
+				}
+
+			}
+
+			else { /* ERROR */
+					fprintf(stderr, "ERROR: unknown condition 84792740 [%d][%d].\n",
+						Data_Dictionary[j].datatype, Data_Dictionary[j].testtype) ;
+					fail(3) ;
+				}
+
+		} /* for every term */
+
+
+
+
+
+	    fprintf(stream, "\n" ) ;
+	  }
+	} /* foreach rule */
+
+
+
+
+
+
+	
+	/* Conclude printin of rule base */
+	if (verbose) fprintf(stream, "\n\n") ;
+	fflush(stream) ;
+	free(rules) ;
+ 	if (debug) fprintf(stderr, "} Finished Rule Display %d\n", i);
+}
+
+
+/*****************************************************************************
+** dump_rules()
+**
+** Rewrite the -f rule file with the report of the objects so far, or
+** print it to stderr without -f. Called with the queue locked on SIGUSR1.
+*****************************************************************************/
+void dump_rules(struct Generator *gen) {
+   if (gen->rule_fd == NULL) {
+	report_rules(gen, stderr) ;
+	return ;
+   }
+
+   rewind(gen->rule_fd) ;
+   report_rules(gen, gen->rule_fd) ;
+   if (ftruncate(fileno(gen->rule_fd), (off_t)ftell(gen->rule_fd)) != 0) {
+	perror("ERROR: writing the rule file") ;
+	fail(3) ;
+   }
+}
+
+
+/*****************************************************************************
+** count_rules()
+**
+** Add the objects the worker created by each rule since the last call to
+** the rule base. Called with the queue locked.
+*****************************************************************************/
+void count_rules(struct Worker *w) {
+   int	j ;
+
+   for (j=0; j<=w->gen->cnf_rules; j++) {
+	w->gen->rules[j].objects += w->rule_objects[j] ;
+	w->rule_objects[j] = 0 ;
+   }
+}
+
+
+/*****************************************************************************
+** take_tokens()
+**
+** -L: take units, objects or bytes, from the token bucket of the queue,
+** which fills at rate per second up to a second's worth. When it runs
+** short the chunk waiting to be written holds its turn until the debt is
+** paid off. Called with the queue locked, which is given up meanwhile.
+*****************************************************************************/
+void take_tokens(struct Chunk_queue *q, double rate, double units) {
+   struct timespec	due ;
+   double		now = clock_seconds(), wake ;
+
+   q->tokens += (now - q->refilled) * rate ;
+   if (q->tokens > rate) q->tokens = rate ;
+   q->refilled = now ;
+   q->tokens  -= units ;
+   if (q->tokens >= 0) return ;
+
+   /* a tenth of a second at a time, so that a stop is not held up */
+   wake = now - q->tokens / rate ;
+   while (! stop_requested && now < wake) {
+	if (wake - now > 0.1) now += 0.1 ;
+	else now = wake ;
+	due.tv_sec  = (time_t)now ;
+	due.tv_nsec = (long)((now - (double)due.tv_sec) * 1e9) ;
+	pthread_cond_timedwait(&q->turn, &q->lock, &due) ;
+	now = clock_seconds() ;
+   }
+}
+
+
+/*****************************************************************************
+** clock_seconds()
+**
+** The time of day in seconds, as pthread_cond_timedwait() counts it.
+*****************************************************************************/
+double clock_seconds() {
+   struct timeval	tv ;
+
+   gettimeofday(&tv, NULL) ;
+   return((double)tv.tv_sec + tv.tv_usec / 1e6) ;
+}
+
+
+/*****************************************************************************
+** on_signal()
+**
+** A stream stops claiming chunks on SIGINT or SIGTERM, and when its
+** reader goes away (SIGPIPE is ignored and write() fails with EPIPE), so
+** that the chunks in hand, the end of the format and the -f report are
+** still written. A second SIGINT or SIGTERM kills it. SIGUSR1 asks for
+** the -f report of the objects so far.
+*****************************************************************************/
+void on_signal(int sig) {
+   if (sig == SIGUSR1) {
+	report_requested = 1 ;
+	signal(sig, on_signal) ;
+   }
+   else {
+	stop_requested = 1 ;
+	signal(sig, SIG_DFL) ;
+   }
+}
+
+
+/*****************************************************************************
+** out_printf()
+**
+** printf() into an output buffer, growing it when it gets close to full.
+** A single call must not produce more than OUT_FIELD_MAX characters.
+*****************************************************************************/
+void out_printf(struct Out_buffer *ob, char *format, ...) {
+   va_list	args ;
+
+   if (ob->length + OUT_FIELD_MAX > ob->size) {
+	ob->size = 2*ob->size + OUT_FIELD_MAX ;
+	ob->text = (char *)realloc(ob->text, (size_t)ob->size) ;
+	if (ob->text == NULL) {
+		fprintf(stderr, "ERROR: out of memory for the output buffer\n") ;
+		fail(3) ;
+	}
+   }
+
+   va_start(args, format) ;
+   ob->length += vsprintf(ob->text + ob->length, format, args) ;
+   va_end(args) ;
+}
+
+
+/*****************************************************************************
+** out_grow()
+**
+** Make room for n more characters (and one more out_printf()) in ob.
+*****************************************************************************/
+static void out_grow(struct Out_buffer *ob, long n) {
+
+   while (ob->length + n + OUT_FIELD_MAX > ob->size) {
+	ob->size = 2*ob->size + OUT_FIELD_MAX ;
+	ob->text = (char *)realloc(ob->text, (size_t)ob->size) ;
+	if (ob->text == NULL) {
+		fprintf(stderr, "ERROR: out of memory for the output buffer\n") ;
+		fail(3) ;
+	}
+   }
+}
+
+
+/*****************************************************************************
+** out_text()
+**
+** Append length characters of text to ob, then the end character unless
+** it is 0.
+*****************************************************************************/
+void out_text(struct Out_buffer *ob, char *text, int length, char end) {
+
+   if (ob->length + length + OUT_FIELD_MAX > ob->size) out_grow(ob, length) ;
+
+   memcpy(ob->text + ob->length, text, (size_t)length) ;
+   ob->length += length ;
+   if (end) ob->text[ob->length++] = end ;
+}
+
+
+/*****************************************************************************
+** out_int()
+**
+** Append value as %d would print it, then the end character.
+*****************************************************************************/
+void out_int(struct Out_buffer *ob, long value, char end) {
+   char		digits[24] ;
+   unsigned long magnitude ;
+   int		n = sizeof(digits) ;
+
+   if (ob->length + OUT_FIELD_MAX > ob->size) out_grow(ob, 0) ;
+
+   magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value ;
+   do {
+	digits[--n] = (char)('0' + magnitude % 10) ;
+	magnitude /= 10 ;
+   } while (magnitude) ;
+   if (value < 0) digits[--n] = '-' ;
+
+   memcpy(ob->text + ob->length, digits + n, sizeof(digits) - n) ;
+   ob->length += sizeof(digits) - n ;
+   ob->text[ob->length++] = end ;
+}
+
+
+/*****************************************************************************
+** out_float()
+**
+** Append value as %g would print it, then the end character.
+**
+** %g keeps six significant digits and drops trailing zeros. Values from
+** 1e-4 up to 999999 are printed without an exponent, so they are scaled
+** by an exact power of ten and rounded to a six digit integer here. The
+** rest, and scaled values too close to a rounding tie to be sure of,
+** are left to sprintf().
+*****************************************************************************/
+void out_float(struct Out_buffer *ob, float value, char end) {
+   static double power[10] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 } ;
+   double	x = value, scaled, fraction ;
+   long		digits, whole, unit ;
+   int		exponent, places, n ;
+   char		*p ;
+
+   if (ob->length + OUT_FIELD_MAX > ob->size) out_grow(ob, 0) ;
+
+   if (x < 0) x = -x ;
+
+   /* zero (and -0), exponent notation, NaN and infinity */
+   if (! (x >= 1e-4 && x < 999999.5)) {
+	ob->length += sprintf(ob->text + ob->length, "%g%c", value, end) ;
+	return ;
+   }
+
+   /* x in [10^exponent, 10^(exponent+1)) */
+   for (exponent=5; exponent > -4 && x < (exponent >= 0 ? power[exponent]
+		: 1.0/power[-exponent]); exponent--) ;
+
+   scaled   = x * power[5-exponent] ;	/* exact power, one rounding */
+   digits   = (long)scaled ;
+   fraction = scaled - digits ;
+
+   if (fraction > 0.5 - 1e-6 && fraction < 0.5 + 1e-6) {
+	ob->length += sprintf(ob->text + ob->length, "%g%c", value, end) ;
+	return ;
+   }
+   if (fraction > 0.5) digits++ ;
+
+   /* rounded up to the next power of ten or out of the fixed range */
+   if (digits < 100000 || digits > 999999) {
+	ob->length += sprintf(ob->text + ob->length, "%g%c", value, end) ;
+	return ;
+   }
+
+   p = ob->text + ob->length ;
+   if (value < 0) *p++ = '-' ;
+
+   /* integer part, then the fraction without its trailing zeros */
+   places = 5 - exponent ;
+   if (exponent >= 0) {
+	unit  = (long)power[places] ;
+	whole = digits / unit ;
+	digits %= unit ;
+	for (n=exponent; n>=0; n--) {
+	   p[n] = (char)('0' + whole % 10) ;
+	   whole /= 10 ;
+	}
+	p += exponent + 1 ;
+   }
+   else *p++ = '0' ;
+
+   if (digits) {
+	while (digits % 10 == 0) { digits /= 10 ; places-- ; }
+	*p++ = '.' ;
+	for (n=places-1; n>=0; n--) {
+	   p[n] = (char)('0' + digits % 10) ;
+	   digits /= 10 ;
+	}
+	p += places ;
+   }
+
+   *p++ = end ;
+   ob->length = p - ob->text ;
+}
+
+
+/*****************************************************************************
+** out_write()
+**
+** Write the buffer to standard output, or the -o file, with write() and
+** empty it. stdout must have been flushed beforehand.
+*****************************************************************************/
+void out_write(struct Out_buffer *ob) {
+   char	*text = ob->text ;
+   long	left  = ob->length ;
+   long	n ;
+
+   while (left > 0) {
+	n = (long)write(output_fd, text, (size_t)left) ;
+	if (n < 0) {
+	   if (errno == EINTR) continue ;
+	   /* the reader of a stream went away, see on_signal() */
+	   if (errno == EPIPE) {
+		stop_requested = 1 ;
+		break ;
+	   }
+	   perror("ERROR: writing the objects") ;
+	   fail(3) ;
+	}
+	text += n ;
+	left -= n ;
+   }
+   ob->length = 0 ;
+}
+
+/*****************************************************************************
+** out_pwrite()
+**
+** Write the buffer at the given offset of the -o file with pwrite() and
+** empty it. Threads write their chunks this way side by side.
+*****************************************************************************/
+void out_pwrite(struct Out_buffer *ob, long offset) {
+   char	*text = ob->text ;
+   long	left  = ob->length ;
+   long	n ;
+
+   while (left > 0) {
+	n = (long)pwrite(output_fd, text, (size_t)left, (off_t)offset) ;
+	if (n < 0) {
+	   if (errno == EINTR) continue ;
+	   perror("ERROR: writing the objects") ;
+	   fail(3) ;
+	}
+	text   += n ;
+	offset += n ;
+	left   -= n ;
+   }
+   ob->length = 0 ;
+}
+
+
+/*****************************************************************************
+** out_allocate()
+**
+** Called with the queue locked once chunk has been placed. When the -o
+** file has outgrown its allocation, allocate what the chunks so far
+** predict for the whole run, and a sixteenth more, so that the disk
+** space is laid out in a few large extents. Only a hint: the file is cut
+** to its real length at the end, and where posix_fallocate() is missing
+** or unsupported nothing is allocated.
+*****************************************************************************/
+void out_allocate(struct Chunk_queue *q, long chunk) {
+   long	estimate ;
+
+   /* an endless stream has no size to predict */
+   if (q->written <= q->allocated || q->chunks == LONG_MAX) return ;
+
+   estimate = q->written / (chunk+1) * q->chunks ;
+   estimate += estimate / 16 ;
+   if (estimate < q->written) estimate = q->written ;
+
+#ifdef __linux__
+   posix_fallocate(output_fd, (off_t)q->allocated, (off_t)(estimate - q->allocated)) ;
+#endif
+   q->allocated = estimate ;
+}
+
+
+/*****************************************************************************
+** out_compress()
+**
+** Replace the text of ob by a complete gzip member holding it, compressed
+** at the given zlib level. packed is the scratch buffer it trades places
+** with. Concatenated members are one valid gzip stream, and each can be
+** decompressed on its own.
+*****************************************************************************/
+void out_compress(struct Out_buffer *ob, struct Out_buffer *packed, int level) {
+   struct Out_buffer	swap ;
+   z_stream		z ;
+
+   z.zalloc = Z_NULL ;
+   z.zfree  = Z_NULL ;
+   z.opaque = Z_NULL ;
+   if (deflateInit2(&z, level, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+	fprintf(stderr, "ERROR: could not start the gzip compression\n") ;
+	fail(3) ;
+   }
+
+   packed->length = 0 ;
+   out_grow(packed, (long)deflateBound(&z, (uLong)ob->length)) ;
+
+   z.next_in   = (Bytef *)ob->text ;
+   z.avail_in  = (uInt)ob->length ;
+   z.next_out  = (Bytef *)packed->text ;
+   z.avail_out = (uInt)packed->size ;
+   if (deflate(&z, Z_FINISH) != Z_STREAM_END) {
+	fprintf(stderr, "ERROR: gzip compression failed\n") ;
+	fail(3) ;
+   }
+   packed->length = (long)z.total_out ;
+   deflateEnd(&z) ;
+
+   swap    = *ob ;
+   *ob     = *packed ;
+   *packed = swap ;
+}
+
+
+
+/*****************************************************************
+******************************************************************
+** OUTPUT FORMAT PROCEDURES					**
+******************************************************************
+*****************************************************************/
+
+/*****************************************************************************
+** format_named()
+**
+** The OUT_ format of a -t name, or -1 when there is none.
+*****************************************************************************/
+int format_named(char *name) {
+
+   if (strcmp(name, "tsv") == 0) return(OUT_TSV) ;
+   if (strcmp(name, "arrow") == 0) return(OUT_ARROW) ;
+   if (strcmp(name, "arrows") == 0) return(OUT_ARROW_STREAM) ;
+   if (strcmp(name, "parquet") == 0) return(OUT_PARQUET) ;
+   if (strcmp(name, "npy") == 0) return(OUT_NPY) ;
+   if (strcmp(name, "libsvm") == 0) return(OUT_LIBSVM) ;
+   if (strcmp(name, "arff") == 0) return(OUT_ARFF) ;
+   if (strcmp(name, "rows") == 0) return(OUT_ROWS) ;
+   return(-1) ;
+}
+
+
+/*****************************************************************************
+** Small FlatBuffers writer for the Arrow IPC metadata.
+**
+** The buffer is written front to back: a table is followed by its vtable
+** and then by the strings, vectors and tables it refers to. Each offset
+** field is patched when the object it refers to is placed, so 'at' is
+** the position of the offset field pointing at the new object.
+** FlatBuffers are little-endian whatever the host.
+*****************************************************************************/
+static void fb_pad(struct Out_buffer *fb, int align) {
+
+   if (fb->length + align + OUT_FIELD_MAX > fb->size) out_grow(fb, (long)align) ;
+   while (fb->length % align) fb->text[fb->length++] = 0 ;
+}
+
+static void fb_put(struct Out_buffer *fb, long at, long value, int size) {
+   int	b ;
+
+   for (b=0; b<size; b++) {
+	fb->text[at+b] = (char)(value & 0xFF) ;
+	value >>= 8 ;		/* the sign fills the high bytes */
+   }
+}
 
-			/* add +1 to include the dom_max value */
-			random_ordinal = int_rand((int)(1 + Data_Dictionary[k].dom_max-Data_Dictionary[k].dom_min)) ;
-			random_ordinal += (int)Data_Dictionary[k].dom_min ;
+static long fb_scalar(struct Out_buffer *fb, long value, int size) {
+   long	at ;
 
-			new_object[k] = (float)random_ordinal ;
-			if (debug) fprintf(stderr, " ord[%d] ", random_ordinal) ;
-		}
-		else if (Data_Dictionary[k].datatype == CONTINUOUS) {
+   fb_pad(fb, size) ;
+   at = fb->length ;
+   fb_put(fb, at, value, size) ;
+   fb->length += size ;
+   return(at) ;
+}
 
-			new_object[k] =
-				(float)Data_Dictionary[k].dom_min + (float)n_rand(1.0) *
-				(Data_Dictionary[k].dom_max - Data_Dictionary[k].dom_min) ;
+static void fb_table_begin(struct Out_buffer *fb, struct Fb_table *t, int fields, long at) {
+   int	f ;
 
-		}
-		else {
-			   fprintf(stderr, "\nERROR 294489473.\n") ;
-			   exit(3) ;
-		}
+   fb_pad(fb, 4) ;
+   if (at >= 0) fb_put(fb, at, fb->length - at, 4) ;
+   t->start  = fb_scalar(fb, 0L, 4) ;	/* soffset to the vtable */
+   t->fields = fields ;
+   for (f=0; f<fields; f++) t->slot[f] = 0 ;
+}
 
-	    } /* open attribute for this rule */
+static long fb_field(struct Out_buffer *fb, struct Fb_table *t, int id, long value, int size) {
+   long	at = fb_scalar(fb, value, size) ;
 
-	    /* This may be a missing attribute-value */
-		/* If so then reset value to MISSINGVAL */
-	    if ( miss_ratio > n_rand() ) {
-			new_object[k] = MISSINGVAL ;
-	    }
+   t->slot[id] = (int)(at - t->start) ;
+   return(at) ;
+}
 
-	} /* create each object's attribute */
+static void fb_table_end(struct Out_buffer *fb, struct Fb_table *t) {
+   long	table_size = fb->length - t->start ;
+   long	vtable ;
+   int	f ;
 
+   vtable = fb_scalar(fb, 4L + 2*t->fields, 2) ;
+   fb_scalar(fb, table_size, 2) ;
+   for (f=0; f<t->fields; f++) fb_scalar(fb, (long)t->slot[f], 2) ;
 
-	/*******************************************************************
-	** Test that this new tuple could not be created by another rule. **
-	*******************************************************************/
-	New_object_ok = 1 ;
-	for (n=1; n<=cnf_rules; n++) { /* for each subrule n */
-	  if (n != j) { /* avoid self */
+   fb_put(fb, t->start, t->start - vtable, 4) ;
+}
 
-		int matches = 0 ; /* count the mis/matches for this rule */
-		int mismatches = 0 ;
-		struct Terms	*Term ;
+/* place the length of a vector so that its elements are aligned */
+static long fb_vector(struct Out_buffer *fb, long at, long count, int align) {
 
-		Term = Rules[n].body ;
-				
-		/* Could the object be created by this other rule? */
-		/* Test each term in the subrule */
-		for (m=0; m<attributes; m++) {
-			/* Does the rule have a term on this attribute? */
-			if (Rules[n].attribute_map[m]==1) {
-				int k ;
-			
-				if (Data_Dictionary[m].datatype == NOMINAL) {
-				    /* test whether this value is contained in the set */
-				    int nominal_match=0 ;
-				    for (k=0;k<=Term->setsize;k++) {
-					if ((int)new_object[m] == Term->nominal[k])
-						nominal_match++ ;
-				    }
-				    if (nominal_match) matches++ ;
-				    else mismatches++ ;
-				}
+   fb_pad(fb, 4) ;
+   while ((fb->length + 4) % align) fb_scalar(fb, 0L, 4) ;
+   fb_put(fb, at, fb->length - at, 4) ;
+   return(fb_scalar(fb, count, 4)) ;
+}
 
-				else if (Data_Dictionary[m].datatype == ORDINAL) {
-					if ((new_object[m] >= (float)Term->ordinal[0])
-							&& (new_object[m] <= (float)Term->ordinal[1]))
-						matches++ ;
-					else 
-						mismatches++ ;
-				}
+static void fb_string(struct Out_buffer *fb, long at, char *text) {
+   int	length = (int)strlen(text) ;
 
-				else if (Data_Dictionary[m].datatype == CONTINUOUS) {
-					if ((new_object[m] >= Term->continuous[0])
-							&& (new_object[m] <= Term->continuous[1]))
-						matches++ ;
-					else 
-						mismatches++ ;
-				}
+   fb_vector(fb, at, (long)length, 4) ;
+   out_text(fb, text, length, 0) ;
+   fb_scalar(fb, 0L, 1) ;
+}
 
-			Term = Term->next_term ;
-			}
 
-		} /* for each attribute */
+/*****************************************************************************
+** host_big_endian()
+**
+** 1 when the host stores the most significant byte first. The column
+** buffers are written in host order and the schema says which it is.
+*****************************************************************************/
+static int host_big_endian(void) {
+   int	one = 1 ;
 
+   return(*(char *)&one == 0) ;
+}
 
-		if (debug) fprintf(stderr,
-			"\ndebug: matches [%d] && ! mismatches [%d] = %d\n",
-			matches, mismatches, matches && ! mismatches) ;
-
-		if (matches && ! mismatches) {
-		    New_object_ok = 0 ; /* FALSE */
-		    if (debug) fprintf(stderr,
-				"WARN: Bad new object #%d matches rule %d!\n", i+1, k+1) ;
-			/* terminate the loops */
-		    n=cnf_rules ;		
-		}
-	    
-	  } /* avoid self */
 
-	} /* test each rule k */
+/*****************************************************************************
+** arrow_index_width()
+**
+** Bytes of the dictionary indices of a column with the given number of
+** values: int8, int16 or int32.
+*****************************************************************************/
+int arrow_index_width(long values) {
 
+   if (values <= 127) return(1) ;
+   if (values <= 32767) return(2) ;
+   return(4) ;
+}
 
-	if (debug) {
-		int l ;
-		for (l=0;l<attributes;l++)
-			fprintf(stderr,"%d[%g] ", l, new_object[l]) ;
-		fprintf(stderr,"\n") ;
-	}
-		
 
+/*****************************************************************************
+** arrow_message_begin()
+**
+** Start a Message flatbuffer in fb with the given header type (1 schema,
+** 2 dictionary batch, 3 record batch). Returns the position of its header
+** offset.
+*****************************************************************************/
+long arrow_message_begin(struct Out_buffer *fb, int header_type, long body_length) {
+   struct Fb_table	message ;
+   long			root, header ;
 
-	/**************************************************************
-	** If the new object is OK then PRINT IT otherwise try again **
-	**************************************************************/
-	if (New_object_ok) {
-	  /* update the number of objects for this rule */
-	  Rules[j].objects++ ;
+   fb->length = 0 ;
+   root = fb_scalar(fb, 0L, 4) ;
 
-	  /* Display the object id */
-	  if(verbose) fprintf(stdout, "%5d:\t\t", i+1) ;
+   fb_table_begin(fb, &message, 5, root) ;
+   fb_field(fb, &message, 3, body_length, 8) ;	/* bodyLength */
+   header = fb_field(fb, &message, 2, 0L, 4) ;	/* header */
+   fb_field(fb, &message, 0, 4L, 2) ;		/* version V5 */
+   fb_field(fb, &message, 1, (long)header_type, 1) ;
+   fb_table_end(fb, &message) ;
 
-	  /* Cycle through each attribute */
-	  for (k=0; k<attributes; k++) {
+   return(header) ;
+}
 
-	    /* Hold string NOMINAL values */
-        char buffer[256] ;
 
-		if (debug) printf("%d|", k) ;
+/*****************************************************************************
+** arrow_message_end()
+**
+** Append the Message in fb to ob as an encapsulated IPC message: the
+** continuation marker, the metadata length and the metadata padded to 8
+** bytes. The caller appends the body. Returns the length of this prefix.
+*****************************************************************************/
+int arrow_message_end(struct Out_buffer *fb, struct Out_buffer *ob) {
 
-		/* This attribute is masked */
-		if (Data_Dictionary[k].masked) {
-		    if (verbose) printf("   *\t" ) ;
-		}
+   fb_pad(fb, 8) ;
+   out_grow(ob, fb->length + 8) ;
+   fb_put(ob, ob->length, -1L, 4) ;
+   fb_put(ob, ob->length + 4, fb->length, 4) ;
+   ob->length += 8 ;
+   out_text(ob, fb->text, (int)fb->length, 0) ;
 
-		/* supply a rule-independent (erroneously entered) attribute-value */
-		else if ( attrib_error > n_rand( 1.0 ) ) {
-		  if (debug) printf("er[%d] ", 
-			  Data_Dictionary[k].datatype) ;
+   return((int)(8 + fb->length)) ;
+}
 
-		  if (Data_Dictionary[k].datatype == NOMINAL) {
 
-			int rand_val = 1 + int_rand((int)Data_Dictionary[k].dom_max) ;
+/*****************************************************************************
+** arrow_record_batch_meta()
+**
+** Place a RecordBatch table of the given field nodes (length, null count)
+** and body buffers (offset, length), referred to by the offset at 'at'.
+*****************************************************************************/
+void arrow_record_batch_meta(struct Out_buffer *fb, long at, long rows,
+		int nodes, long *node, int buffers, long *buffer) {
+   struct Fb_table	batch ;
+   long			nodes_at, buffers_at ;
+   int			n ;
+
+   fb_table_begin(fb, &batch, 4, at) ;
+   fb_field(fb, &batch, 0, rows, 8) ;		/* length */
+   nodes_at   = fb_field(fb, &batch, 1, 0L, 4) ;
+   buffers_at = fb_field(fb, &batch, 2, 0L, 4) ;
+   fb_table_end(fb, &batch) ;
+
+   fb_vector(fb, nodes_at, (long)nodes, 8) ;
+   for (n=0; n<2*nodes; n++) fb_scalar(fb, node[n], 8) ;
+
+   fb_vector(fb, buffers_at, (long)buffers, 8) ;
+   for (n=0; n<2*buffers; n++) fb_scalar(fb, buffer[n], 8) ;
+}
 
-		    num2str(rand_val, buffer) ;
 
-			if (verbose)	printf("%4s*\t", buffer ) ;
-			else			printf("%s\t", buffer ) ;
-		  }
-/*sss*/
-		  else if (Data_Dictionary[k].datatype == ORDINAL) {
-			int rand_val = (int)Data_Dictionary[k].dom_min
-						+ int_rand((int)Data_Dictionary[k].dom_max - (int)Data_Dictionary[k].dom_min) ;
+/*****************************************************************************
+** arrow_schema()
+**
+** Place the Schema table, referred to by the offset at 'at'. There is one
+** field for each visible attribute, in order, then one for the class:
+** NOMINAL values and the class are dictionary-encoded utf8, ORDINAL values
+** int32 and CONTINUOUS values float32. Dictionary k belongs to attribute k,
+** the class dictionary has the id attributes.
+*****************************************************************************/
+void arrow_schema(struct Out_buffer *fb, long at, struct Generator *gen) {
+   struct Attribute_def *Data_Dictionary = gen->dictionary ;
+   struct Fb_table	schema, field, type, encoding, index ;
+   long			fields_at, slots, name_at, type_at, dictionary_at ;
+   long			children_at, index_at, values ;
+   int			k, n, columns, datatype ;
+   char			*name ;
+
+   for (k=0, columns=1; k<gen->attributes; k++)
+	if (! Data_Dictionary[k].masked) columns++ ;
+
+   fb_table_begin(fb, &schema, 4, at) ;
+   fields_at = fb_field(fb, &schema, 1, 0L, 4) ;
+   fb_field(fb, &schema, 0, (long)host_big_endian(), 2) ;
+   fb_table_end(fb, &schema) ;
+
+   slots = fb_vector(fb, fields_at, (long)columns, 4) + 4 ;
+   for (n=0; n<columns; n++) fb_scalar(fb, 0L, 4) ;
+
+   for (k=0, n=0; k<=gen->attributes; k++) {
+
+	if (k < gen->attributes) {
+	   if (Data_Dictionary[k].masked) continue ;
+	   name     = Data_Dictionary[k].name ;
+	   datatype = Data_Dictionary[k].datatype ;
+	   values   = (long)Data_Dictionary[k].dom_max ;
+	}
+	else {
+	   name     = class_name ;
+	   datatype = NOMINAL ;
+	   values   = gen->classes + 1 ;
+	}
 
-			if (verbose)	printf("%4d*\t", rand_val ) ;
-			else			printf("%d\t" , rand_val ) ;
-		  }
+	fb_table_begin(fb, &field, 7, slots + 4*n++) ;
+	name_at     = fb_field(fb, &field, 0, 0L, 4) ;
+	type_at     = fb_field(fb, &field, 3, 0L, 4) ;
+	children_at = fb_field(fb, &field, 5, 0L, 4) ;
+	dictionary_at = -1 ;
+	if (datatype == NOMINAL)
+	   dictionary_at = fb_field(fb, &field, 4, 0L, 4) ;
+	fb_field(fb, &field, 1, (long)(k < gen->attributes), 1) ;	/* nullable */
+	fb_field(fb, &field, 2, datatype == NOMINAL ? 5L		/* Utf8 */
+		: datatype == ORDINAL ? 2L : 3L, 1) ;		/* Int, FloatingPoint */
+	fb_table_end(fb, &field) ;
+
+	fb_string(fb, name_at, name) ;
+
+	fb_table_begin(fb, &type, 2, type_at) ;
+	if (datatype == ORDINAL) {
+	   fb_field(fb, &type, 0, 32L, 4) ;	/* bitWidth */
+	   fb_field(fb, &type, 1, 1L, 1) ;	/* is_signed */
+	}
+	else if (datatype == CONTINUOUS)
+	   fb_field(fb, &type, 0, 1L, 2) ;	/* precision SINGLE */
+	fb_table_end(fb, &type) ;
+
+	if (dictionary_at >= 0) {
+	   fb_table_begin(fb, &encoding, 4, dictionary_at) ;
+	   fb_field(fb, &encoding, 0, (long)k, 8) ;	/* id */
+	   index_at = fb_field(fb, &encoding, 1, 0L, 4) ;
+	   fb_table_end(fb, &encoding) ;
+
+	   fb_table_begin(fb, &index, 2, index_at) ;
+	   fb_field(fb, &index, 0, 8L * arrow_index_width(values), 4) ;
+	   fb_field(fb, &index, 1, 1L, 1) ;
+	   fb_table_end(fb, &index) ;
+	}
 
-	
-		  else if (Data_Dictionary[k].datatype == CONTINUOUS) {
-			float rand_val = Data_Dictionary[k].dom_min + (float)(n_rand(1.0) *
-				(Data_Dictionary[k].dom_max - Data_Dictionary[k].dom_min)) ;
+	fb_vector(fb, children_at, 0L, 4) ;
+   }
+}
 
-			if (verbose)	printf("%5.2g*\t", rand_val ) ;
-			else			printf("%5.2g\t" , rand_val ) ;
-		  }
 
-		  
-		  else {
-			fprintf(stderr, "\nERROR 294489473.\n") ;
-			exit(2) ;
-		  }
+/*****************************************************************************
+** arrow_dictionary()
+**
+** Append the dictionary batch of attribute k (or of the class when k is
+** gen->attributes) to ob: the labels of values 1 .. dom_max, or c0 .. cN.
+*****************************************************************************/
+void arrow_dictionary(struct Generator *gen, int k, struct Out_buffer *fb,
+		struct Out_buffer *ob, int *meta_length, long *body_length) {
+   struct Fb_table	dictionary ;
+   long			values, text_length, offsets_length, data_at, v ;
+   long			node[2], buffer[6] ;
+   char			label[32] ;
+   int			length, offset ;
+
+   values = k < gen->attributes ? (long)gen->dictionary[k].dom_max : gen->classes + 1 ;
+
+   for (v=0, text_length=0; v<values; v++)
+	if (k < gen->attributes) text_length += LABEL_LENGTH(v+1) ;
+	else text_length += sprintf(label, "c%ld", v) ;
+
+   offsets_length = 4 * (values+1) ;
+   node[0] = values ;	node[1] = 0 ;
+   buffer[0] = 0 ;	buffer[1] = 0 ;			/* no validity bitmap */
+   buffer[2] = 0 ;	buffer[3] = offsets_length ;
+   buffer[4] = PAD8(offsets_length) ; buffer[5] = text_length ;
+   *body_length = PAD8(offsets_length) + PAD8(text_length) ;
+
+   fb_table_begin(fb, &dictionary, 3, arrow_message_begin(fb, 2, *body_length)) ;
+   fb_field(fb, &dictionary, 0, (long)k, 8) ;	/* id */
+   data_at = fb_field(fb, &dictionary, 1, 0L, 4) ;
+   fb_table_end(fb, &dictionary) ;
+   arrow_record_batch_meta(fb, data_at, values, 1, node, 3, buffer) ;
+
+   *meta_length = arrow_message_end(fb, ob) ;
+
+   /* int32 offsets, then the utf8 text */
+   out_grow(ob, *body_length) ;
+   for (v=0, offset=0; v<=values; v++) {
+	memcpy(ob->text + ob->length, &offset, 4) ;
+	ob->length += 4 ;
+	if (v == values) break ;
+	if (k < gen->attributes) offset += LABEL_LENGTH(v+1) ;
+	else offset += sprintf(label, "c%ld", v) ;
+   }
+   fb_pad(ob, 8) ;
 
-		
-		} /* an erroneously entered value */
+   for (v=0; v<values; v++) {
+	if (k < gen->attributes) {
+	   length = LABEL_LENGTH(v+1) ;
+	   out_text(ob, LABEL(v+1), length, 0) ;
+	}
+	else {
+	   length = sprintf(label, "c%ld", v) ;
+	   out_text(ob, label, length, 0) ;
+	}
+   }
+   fb_pad(ob, 8) ;
+}
 
 
-		/* missing attribute-value */
-		else if (new_object[k] == MISSINGVAL) {
-		  if (debug) printf("mi[%d] ", 
-			  Data_Dictionary[k].datatype) ;
+/*****************************************************************************
+** arrow_record_batch()
+**
+** Append the objects of the batch to ob as one record batch message.
+** Missing values are null; the validity bitmap is left out of a column
+** without nulls.
+*****************************************************************************/
+void arrow_record_batch(struct Generator *gen, struct Batch *batch,
+		struct Out_buffer *fb, struct Out_buffer *ob, int *meta_length, long *body_length) {
+   struct Attribute_def *Data_Dictionary = gen->dictionary ;
+   long		rows = batch->rows, r, nulls, offset, bitmap ;
+   long		*node, *buffer ;
+   int		attributes = gen->attributes ;
+   int		k, n, width ;
+   float	*value ;
+
+   node   = (long *)malloc(2 * (attributes+1) * sizeof(long)) ;
+   buffer = (long *)malloc(4 * (attributes+1) * sizeof(long)) ;
+   bitmap = (rows + 7) / 8 ;
+
+   /* lay out the body */
+   for (k=0, n=0, offset=0; k<=attributes; k++) {
+
+	if (k < attributes) {
+	   if (Data_Dictionary[k].masked) continue ;
+	   for (r=0, nulls=0; r<rows; r++)
+		if (batch->values[r*attributes + k] == MISSINGVAL) nulls++ ;
+	   width = Data_Dictionary[k].datatype == NOMINAL ?
+		arrow_index_width((long)Data_Dictionary[k].dom_max) : 4 ;
+	}
+	else {
+	   nulls = 0 ;
+	   width = arrow_index_width((long)gen->classes + 1) ;
+	}
 
-		  if (verbose)
-			printf("%4s\t", MISSINGVALCHAR ) ;
-		  
-		  else
-			printf("%s\t", MISSINGVALCHAR) ;
+	node[2*n]     = rows ;
+	node[2*n + 1] = nulls ;
+	buffer[4*n]     = offset ;
+	buffer[4*n + 1] = nulls ? bitmap : 0 ;
+	offset += PAD8(buffer[4*n + 1]) ;
+	buffer[4*n + 2] = offset ;
+	buffer[4*n + 3] = rows * width ;
+	offset += PAD8(buffer[4*n + 3]) ;
+	n++ ;
+   }
+   *body_length = offset ;
+
+   arrow_record_batch_meta(fb, arrow_message_begin(fb, 3, offset), rows, n, node, 2*n, buffer) ;
+   *meta_length = arrow_message_end(fb, ob) ;
+
+   /* the body: each column's validity bitmap and values */
+   out_grow(ob, offset) ;
+   for (k=0, n=0; k<=attributes; k++) {
+	int	datatype = NOMINAL ;
+
+	if (k < attributes) {
+	   if (Data_Dictionary[k].masked) continue ;
+	   datatype = Data_Dictionary[k].datatype ;
+	   width = datatype == NOMINAL ? arrow_index_width((long)Data_Dictionary[k].dom_max) : 4 ;
+	}
+	else width = arrow_index_width((long)gen->classes + 1) ;
+
+	if (node[2*n + 1]) {
+	   unsigned char *bits = (unsigned char *)ob->text + ob->length ;
+
+	   memset(bits, 0, (size_t)bitmap) ;
+	   for (r=0; r<rows; r++)
+		if (batch->values[r*attributes + k] != MISSINGVAL)
+		   bits[r/8] |= (unsigned char)(1 << (r%8)) ;
+	   ob->length += bitmap ;
+	   fb_pad(ob, 8) ;
+	}
+
+	for (r=0; r<rows; r++) {
+	   char		*cell = ob->text + ob->length + r*width ;
+	   int		code ;
+
+	   if (k == attributes) code = batch->class[r] ;
+	   else {
+		value = &batch->values[r*attributes + k] ;
+		if (datatype == CONTINUOUS) {
+		   float real = *value == MISSINGVAL ? 0.0f : *value ;
+		   memcpy(cell, &real, 4) ;
+		   continue ;
 		}
+		code = *value == MISSINGVAL ? 0 : (int)*value ;
+		if (datatype == NOMINAL && code > 0) code-- ;	/* value 1 is index 0 */
+	   }
 
-		/* all hurdles were passed */
-		else {
+	   if (width == 1) { signed char c = (signed char)code ; memcpy(cell, &c, 1) ; }
+	   else if (width == 2) { short c = (short)code ; memcpy(cell, &c, 2) ; }
+	   else memcpy(cell, &code, 4) ;
+	}
+	ob->length += rows * width ;
+	fb_pad(ob, 8) ;
+	n++ ;
+   }
 
-			if (debug) printf("ok[%d] ",
-				Data_Dictionary[k].datatype) ;
+   free(node) ;
+   free(buffer) ;
+}
 
-			if (Data_Dictionary[k].datatype == NOMINAL) {
-				if (verbose) {
-					num2str((int)new_object[k], buffer) ;
-					printf("%4s\t", buffer ) ;
-				}
 
-				else {
-					num2str((int)new_object[k], buffer) ;
-					printf("%s\t", buffer ) ;
-			    }
-			}
+/*****************************************************************************
+** arrow_begin()
+**
+** Write what precedes the record batches: the file magic (IPC file only),
+** the schema and a dictionary batch for each nominal column and the class.
+** The dictionary blocks are kept for the file footer.
+*****************************************************************************/
+void arrow_begin(struct Generator *gen, struct Chunk_queue *q) {
+   struct Out_buffer	fb, ob ;
+   int			k, meta_length ;
+   long			body_length ;
+
+   fb.size = ob.size = 4096 ;
+   fb.text = (char *)malloc((size_t)fb.size) ;
+   ob.text = (char *)malloc((size_t)ob.size) ;
+   fb.length = ob.length = 0 ;
+
+   if (gen->format == OUT_ARROW) out_text(&ob, "ARROW1\0\0", 8, 0) ;
+
+   arrow_schema(&fb, arrow_message_begin(&fb, 1, 0L), gen) ;
+   arrow_message_end(&fb, &ob) ;
+   q->written += ob.length ;
+   out_write(&ob) ;
+
+   for (k=0; k<=gen->attributes; k++) {
+	if (k < gen->attributes && (gen->dictionary[k].masked
+		|| gen->dictionary[k].datatype != NOMINAL)) continue ;
+
+	arrow_dictionary(gen, k, &fb, &ob, &meta_length, &body_length) ;
+	add_block(&q->dictionaries, q->written, meta_length, body_length) ;
+	q->written += ob.length ;
+	out_write(&ob) ;
+   }
 
-		
-			else if (Data_Dictionary[k].datatype == ORDINAL) {	
-				if (verbose) {
-					printf("%4d\t", (int)new_object[k] ) ;
-				}
-				else {
-					printf("%d\t", (int)new_object[k] ) ;
-				}
-			}
-	    
-			else if (Data_Dictionary[k].datatype == CONTINUOUS) {	
-				if (verbose) {
-					printf("%5.2g\t", new_object[k] ) ;
-				}
-				else {
-					printf("%g\t", new_object[k] ) ;
-				}
-			}
-			else { /* ERROR */
-					fprintf(stderr, "ERROR: unknown condition 9359732 [%d].\n",
-						Data_Dictionary[j].datatype) ;
-					exit(3) ;
-			}
+   free(fb.text) ;
+   free(ob.text) ;
+}
 
-	    
-		} /* Printed this attribute's value */
 
-		} /* Cycled through the attributes */
+/*****************************************************************************
+** arrow_end()
+**
+** Write the end-of-stream marker and, for an IPC file, the footer: the
+** schema again and the blocks of the dictionaries and record batches,
+** then the footer length and the closing magic.
+*****************************************************************************/
+void arrow_end(struct Generator *gen, struct Chunk_queue *q) {
+   struct Out_buffer	fb, ob ;
+   struct Fb_table	footer ;
+   struct Block_list	*list ;
+   long			root, schema_at, list_at[2], b ;
+   int			l ;
+
+   fb.size = ob.size = 4096 ;
+   fb.text = (char *)malloc((size_t)fb.size) ;
+   ob.text = (char *)malloc((size_t)ob.size) ;
+   fb.length = ob.length = 0 ;
+
+   fb_scalar(&ob, -1L, 4) ;	/* continuation marker, empty metadata */
+   fb_scalar(&ob, 0L, 4) ;
+
+   if (gen->format == OUT_ARROW) {
+	root = fb_scalar(&fb, 0L, 4) ;
+	fb_table_begin(&fb, &footer, 5, root) ;
+	schema_at  = fb_field(&fb, &footer, 1, 0L, 4) ;
+	list_at[0] = fb_field(&fb, &footer, 2, 0L, 4) ;
+	list_at[1] = fb_field(&fb, &footer, 3, 0L, 4) ;
+	fb_field(&fb, &footer, 0, 4L, 2) ;		/* version V5 */
+	fb_table_end(&fb, &footer) ;
+
+	arrow_schema(&fb, schema_at, gen) ;
+
+	for (l=0; l<2; l++) {
+	   list = l ? &q->batches : &q->dictionaries ;
+	   fb_vector(&fb, list_at[l], list->blocks, 8) ;
+	   for (b=0; b<list->blocks; b++) {
+		fb_scalar(&fb, list->block[3*b], 8) ;		/* offset */
+		fb_scalar(&fb, list->block[3*b + 1], 4) ;	/* metaDataLength */
+		fb_scalar(&fb, 0L, 4) ;
+		fb_scalar(&fb, list->block[3*b + 2], 8) ;	/* bodyLength */
+	   }
+	}
+	fb_pad(&fb, 8) ;
 
+	out_text(&ob, fb.text, (int)fb.length, 0) ;
+	fb_scalar(&ob, fb.length, 4) ;
+	out_text(&ob, "ARROW1", 6, 0) ;
+   }
+   out_write(&ob) ;
 
-	    /* Finally, report the class value */
-	    {   int class = Rules[j].tail ;
+   free(fb.text) ;
+   free(ob.text) ;
+}
 
-			/* erroneously entered class */
-			if ( class_error > n_rand() ) {
-			    int rand_val = int_rand(classes+1);
-			    class=rand_val ; /* overwrite the correct class */
-			}
-	
-			if (verbose)
-				printf("%5s%d\n", "c", class ) ;
-			else	
-				printf("c%d\n", class ) ;
-		}
+
+/*****************************************************************************
+** add_block()
+**
+** Remember where a message of the IPC file starts and how long its
+** metadata and body are, for the file footer.
+*****************************************************************************/
+void add_block(struct Block_list *list, long offset, int meta_length, long body_length) {
+
+   if (list->blocks == list->size) {
+	list->size  = 2*list->size + 16 ;
+	list->block = (long *)realloc(list->block, 3 * list->size * sizeof(long)) ;
+	if (list->block == NULL) {
+		fprintf(stderr, "ERROR: out of memory for the Arrow file footer\n") ;
+		fail(3) ;
 	}
+   }
+   list->block[3*list->blocks]     = offset ;
+   list->block[3*list->blocks + 1] = meta_length ;
+   list->block[3*list->blocks + 2] = body_length ;
+   list->blocks++ ;
+}
+
+/*****************************************************************************
+** Thrift compact protocol writer for the Parquet metadata.
+**
+** last is the id of the previous field of the struct being written; a
+** nested struct starts its own count at 0 and ends with th_stop().
+*****************************************************************************/
+static void th_varint(struct Out_buffer *ob, unsigned long value) {
 
-	else { /* This object could have been created by another rule */
+   if (ob->length + 16 + OUT_FIELD_MAX > ob->size) out_grow(ob, 16L) ;
+   while (value >= 0x80) {
+	ob->text[ob->length++] = (char)((value & 0x7F) | 0x80) ;
+	value >>= 7 ;
+   }
+   ob->text[ob->length++] = (char)value ;
+}
 
-	    if (object_failures++ > FAILURES_PER_OBJECT * objects) {
-	        /* FAIL: Recreation of this object has occurred too often */
-			fprintf(stderr, 
-				"\nEXCEPTION:\n\tFailed to create all the requested objects.\n") ;
-			fprintf(stderr, 
-				"\tThis domain appears to be too constrained!\n\n") ;
-			exit(1) ;
-	    }
-	} /* object create by another rule */
+static void th_field(struct Out_buffer *ob, int *last, int id, int type) {
 
-    } /* while an object for this rule has not been created */
+   fb_scalar(ob, (long)((id - *last) << 4 | type), 1) ;	/* ids only grow, by 1 .. 15 */
+   *last = id ;
+}
 
-    } /* for each object i */
+static void th_int(struct Out_buffer *ob, int *last, int id, int type, long value) {
 
+   th_field(ob, last, id, type) ;
+   th_varint(ob, value < 0 ? ((unsigned long)~value << 1) | 1 : (unsigned long)value << 1) ;
+}
 
+static void th_string(struct Out_buffer *ob, int *last, int id, char *text) {
+   int	length = (int)strlen(text) ;
 
+   if (id) th_field(ob, last, id, 8) ;		/* 0: an element of a list */
+   th_varint(ob, (unsigned long)length) ;
+   out_text(ob, text, length, 0) ;
+}
 
-   /*********************************************************************
-   ** Display Rules (when verbose)
-   *********************************************************************/
-    
-   if (verbose || rule_fd) {
-	float r ;
-	int firstA, firstB ;
-	FILE	*stream ;
+static void th_list(struct Out_buffer *ob, int *last, int id, int type, long size) {
 
-	if (debug) fprintf(stderr, "\nDEBUG: Display Rules {\n");
+   th_field(ob, last, id, 9) ;
+   if (size < 15) fb_scalar(ob, size << 4 | type, 1) ;
+   else {
+	fb_scalar(ob, (long)(0xF0 | type), 1) ;
+	th_varint(ob, (unsigned long)size) ;
+   }
+}
 
-	if (rule_fd)
-		stream = rule_fd ;
-	else
-		stream = stdout ;
+static void th_stop(struct Out_buffer *ob) {
 
-	/* Sort the rules based on their data set representation */
-	qsort(Rules, cnf_rules, sizeof(struct CNF_Rule), compare_rule_freq) ;
+   fb_scalar(ob, 0L, 1) ;
+}
 
-	if (verbose) fprintf(stream,
-		"\n\nRULES\n\t(activation%%) class <- class description\n\n");
+#define	TH_I32      5	/* compact protocol field types */
+#define	TH_I64      6
+#define	TH_STRUCT   12
 
 
+/*****************************************************************************
+** rle_hybrid()
+**
+** Append n values of the given bit width to ob with Parquet's RLE /
+** bit-packing hybrid encoding: a single run when the values are all
+** equal, otherwise one bit-packed run padded to a multiple of 8 values.
+*****************************************************************************/
+void rle_hybrid(struct Out_buffer *ob, int *codes, long n, int width) {
+   unsigned long	acc ;
+   long			i, groups ;
+   int			bits, b, take ;
 
-	
+   if (n == 0) return ;
 
-	
-	
-	
-		/* Report each rule's composition and performance */
-	for (i=0; i<=cnf_rules; i++) {
-	    struct Terms	*Term ;
+   for (i=1; i<n && codes[i] == codes[0]; i++) ;
 
-	  /* if this is not the default rule or if it is the 
-		default rule that a default rule was specified */
-	  if (Rules[i].default_rule==0 || default_rule>0.0) {
+   if (i == n) {
+	th_varint(ob, (unsigned long)n << 1) ;
+	for (b=0; b<width; b+=8) fb_scalar(ob, (long)((codes[0] >> b) & 0xFF), 1) ;
+	return ;
+   }
 
-        /* print rule id */
-	    if (debug) fprintf(stderr, "  Rule %d\n", i);
+   groups = (n + 7) / 8 ;
+   th_varint(ob, (unsigned long)groups << 1 | 1) ;
+   out_grow(ob, groups * width) ;
+
+   for (i=0, acc=0, bits=0; i<8*groups; i++) {
+	unsigned long v = i < n ? (unsigned long)codes[i] : 0 ;
+
+	for (b=0; b<width; b+=take) {
+	   take = width - b < 8 ? width - b : 8 ;
+	   acc |= ((v >> b) & ((1UL << take) - 1)) << bits ;
+	   bits += take ;
+	   if (bits >= 8) {
+		ob->text[ob->length++] = (char)(acc & 0xFF) ;
+		acc >>= 8 ;
+		bits -= 8 ;
+	   }
+	}
+   }
+}
 
-		/* calculate the rule's activation frequency */
-		r=(float)Rules[i].objects ;
-		r/=objects ;
 
-	    if (verbose) fprintf(stream, "\t") ;
-	    
-		/* (percent) class <- */
-	    fprintf(stream, "(%02.1f%%) c%d <- ",
-			r*100, Rules[i].tail) ;
+/*****************************************************************************
+** parquet_page_header()
+**
+** Append the header of a page holding length bytes of values: a
+** dictionary page of values entries (PLAIN) or a data page of values
+** rows encoded with encoding.
+*****************************************************************************/
+void parquet_page_header(struct Out_buffer *ob, int dictionary, long values,
+		int encoding, long length) {
+   int	last = 0, inner = 0 ;
+
+   th_int(ob, &last, 1, TH_I32, dictionary ? 2L : 0L) ;	/* DICTIONARY_PAGE, DATA_PAGE */
+   th_int(ob, &last, 2, TH_I32, length) ;		/* uncompressed */
+   th_int(ob, &last, 3, TH_I32, length) ;		/* compressed */
+
+   th_field(ob, &last, dictionary ? 7 : 5, TH_STRUCT) ;
+   th_int(ob, &inner, 1, TH_I32, values) ;
+   th_int(ob, &inner, 2, TH_I32, (long)encoding) ;
+   if (! dictionary) {
+	th_int(ob, &inner, 3, TH_I32, 3L) ;	/* levels: RLE */
+	th_int(ob, &inner, 4, TH_I32, 3L) ;
+   }
+   th_stop(ob) ;
+   th_stop(ob) ;
+}
 
-	    if (Rules[i].default_rule==1)
-			fprintf(stream, " default ") ;
 
-		/* for each attribute   used by the rule */
-	    Term=Rules[i].body ;
+/*****************************************************************************
+** parquet_row_group()
+**
+** Append the objects of the batch to ob as one row group: a column chunk
+** per visible attribute and one for the class. NOMINAL columns and the
+** class hold a dictionary page of their labels and a data page of
+** dictionary indices; ORDINAL columns are PLAIN int32 and CONTINUOUS
+** columns PLAIN float. Missing values are left out and marked by the
+** definition levels. For each chunk, its offset in the row group, the
+** length of its dictionary page and its length are added to columns.
+*****************************************************************************/
+void parquet_row_group(struct Generator *gen, struct Batch *batch,
+		struct Out_buffer *page, struct Out_buffer *ob, struct Block_list *columns) {
+   struct Attribute_def *Data_Dictionary = gen->dictionary ;
+   long		rows = batch->rows, r, v, values, start, at ;
+   int		attributes = gen->attributes ;
+   int		k, n, datatype, width, length, dictionary_length ;
+   float	x ;
+   char		label[32] ;
+   unsigned int	bits ;
+
+   columns->blocks = 0 ;
+
+   for (k=0; k<=attributes; k++) {
+
+	if (k < attributes) {
+	   if (Data_Dictionary[k].masked) continue ;
+	   datatype = Data_Dictionary[k].datatype ;
+	   values   = (long)Data_Dictionary[k].dom_max ;
+	}
+	else {
+	   datatype = NOMINAL ;
+	   values   = gen->classes + 1 ;
+	}
+	start = ob->length ;
+	dictionary_length = 0 ;
+
+	/* the dictionary page: the labels as PLAIN byte arrays */
+	if (datatype == NOMINAL) {
+	   page->length = 0 ;
+	   for (v=1; v<=values; v++) {
+		length = k < attributes ? LABEL_LENGTH(v) : sprintf(label, "c%ld", v-1) ;
+		out_grow(page, 4L + length) ;
+		fb_put(page, page->length, (long)length, 4) ;
+		page->length += 4 ;
+		out_text(page, k < attributes ? LABEL(v) : label, length, 0) ;
+	   }
+	   parquet_page_header(ob, 1, values, 0, page->length) ;
+	   out_text(ob, page->text, (int)page->length, 0) ;
+	   dictionary_length = (int)(ob->length - start) ;
+	}
+
+	/* the data page: definition levels of the attributes, then the values */
+	page->length = 0 ;
+	if (k < attributes) {
+	   for (r=0; r<rows; r++)
+		batch->codes[r] = batch->values[r*attributes + k] != MISSINGVAL ;
+	   at = fb_scalar(page, 0L, 4) ;
+	   rle_hybrid(page, batch->codes, rows, 1) ;
+	   fb_put(page, at, page->length - at - 4, 4) ;
+	}
+
+	if (datatype == NOMINAL) {
+	   for (r=0, n=0; r<rows; r++) {
+		if (k == attributes) batch->codes[n++] = batch->class[r] ;
+		else if (batch->values[r*attributes + k] != MISSINGVAL)
+		   batch->codes[n++] = (int)batch->values[r*attributes + k] - 1 ;
+	   }
+	   for (width=1; width<31 && (1L << width) < values; width++) ;
+	   fb_scalar(page, (long)width, 1) ;
+	   rle_hybrid(page, batch->codes, (long)n, width) ;
+	}
+	else {
+	   out_grow(page, 4*rows) ;
+	   for (r=0; r<rows; r++) {
+		x = batch->values[r*attributes + k] ;
+		if (x == MISSINGVAL) continue ;
+		if (datatype == ORDINAL) bits = (unsigned int)(int)x ;
+		else memcpy(&bits, &x, 4) ;
+		fb_put(page, page->length, (long)bits, 4) ;	/* little-endian */
+		page->length += 4 ;
+	   }
+	}
+
+	parquet_page_header(ob, 0, rows, datatype == NOMINAL ? 8 : 0, page->length) ;	/* RLE_DICTIONARY, PLAIN */
+	out_text(ob, page->text, (int)page->length, 0) ;
+
+	add_block(columns, start, dictionary_length, ob->length - start) ;
+   }
+}
 
 
-	    for (j=0, firstA=1; j<attributes; j++) {
-		  if (Rules[i].attribute_map[j]==1) {
+/*****************************************************************************
+** parquet_end()
+**
+** Write the file metadata: the schema, and the row groups with the
+** offsets of their column chunks, then its length and the closing magic.
+*****************************************************************************/
+void parquet_end(struct Generator *gen, struct Chunk_queue *q) {
+   struct Attribute_def *Data_Dictionary = gen->dictionary ;
+   struct Out_buffer	ob ;
+   struct Block_list	*list = &q->batches ;
+   long			groups, g, rows, c, at ;
+   int			k, columns, datatype, last, group, chunk, meta, logical ;
+   char			*name ;
+
+   ob.size = 4096 ;
+   ob.text = (char *)malloc((size_t)ob.size) ;
+   ob.length = 0 ;
+
+   for (k=0, columns=1; k<gen->attributes; k++)
+	if (! Data_Dictionary[k].masked) columns++ ;
+   groups = list->blocks / columns ;
+
+   last = 0 ;
+   th_int(&ob, &last, 1, TH_I32, 1L) ;			/* version */
+
+   th_list(&ob, &last, 2, TH_STRUCT, (long)columns + 1) ;	/* schema */
+   group = 0 ;
+   th_string(&ob, &group, 4, "schema") ;
+   th_int(&ob, &group, 5, TH_I32, (long)columns) ;
+   th_stop(&ob) ;
+   for (k=0; k<=gen->attributes; k++) {
+	if (k < gen->attributes && Data_Dictionary[k].masked) continue ;
+	datatype = k < gen->attributes ? Data_Dictionary[k].datatype : NOMINAL ;
+	name     = k < gen->attributes ? Data_Dictionary[k].name : class_name ;
+
+	group = 0 ;
+	th_int(&ob, &group, 1, TH_I32, datatype == NOMINAL ? 6L	/* BYTE_ARRAY */
+		: datatype == ORDINAL ? 1L : 4L) ;		/* INT32, FLOAT */
+	th_int(&ob, &group, 3, TH_I32, (long)(k < gen->attributes)) ;	/* OPTIONAL, REQUIRED */
+	th_string(&ob, &group, 4, name) ;
+	if (datatype == NOMINAL) {
+	   th_int(&ob, &group, 6, TH_I32, 0L) ;		/* UTF8 */
+	   th_field(&ob, &group, 10, TH_STRUCT) ;	/* logicalType */
+	   logical = 0 ;
+	   th_field(&ob, &logical, 1, TH_STRUCT) ;	/* STRING */
+	   th_stop(&ob) ;
+	   th_stop(&ob) ;
+	}
+	th_stop(&ob) ;
+   }
 
-			/* time for an ampersand & */
-			if (firstA) firstA=!firstA ;
-		    else fprintf(stream, " & ") ;
+   th_int(&ob, &last, 3, TH_I64, gen->objects) ;	/* num_rows */
+
+   th_list(&ob, &last, 4, TH_STRUCT, groups) ;		/* row_groups */
+   for (g=0; g<groups; g++) {
+	rows = g < groups-1 ? q->per_chunk : gen->objects - g*q->per_chunk ;
+
+	group = 0 ;
+	th_list(&ob, &group, 1, TH_STRUCT, (long)columns) ;
+	for (k=0, c=g*columns; k<=gen->attributes; k++) {
+	   if (k < gen->attributes && Data_Dictionary[k].masked) continue ;
+	   datatype = k < gen->attributes ? Data_Dictionary[k].datatype : NOMINAL ;
+	   name     = k < gen->attributes ? Data_Dictionary[k].name : class_name ;
+	   at       = list->block[3*c] ;
+
+	   chunk = 0 ;
+	   th_int(&ob, &chunk, 2, TH_I64, at) ;		/* file_offset */
+	   th_field(&ob, &chunk, 3, TH_STRUCT) ;		/* meta_data */
+	   meta = 0 ;
+	   th_int(&ob, &meta, 1, TH_I32, datatype == NOMINAL ? 6L : datatype == ORDINAL ? 1L : 4L) ;
+	   if (datatype == NOMINAL) {
+		th_list(&ob, &meta, 2, TH_I32, 3L) ;		/* encodings */
+		th_varint(&ob, 0UL) ;			/* PLAIN */
+		th_varint(&ob, 6UL) ;			/* RLE */
+		th_varint(&ob, 16UL) ;			/* RLE_DICTIONARY */
+	   }
+	   else {
+		th_list(&ob, &meta, 2, TH_I32, 2L) ;
+		th_varint(&ob, 0UL) ;
+		th_varint(&ob, 6UL) ;
+	   }
+	   th_list(&ob, &meta, 3, 8, 1L) ;			/* path_in_schema */
+	   th_string(&ob, &meta, 0, name) ;
+	   th_int(&ob, &meta, 4, TH_I32, 0L) ;		/* UNCOMPRESSED */
+	   th_int(&ob, &meta, 5, TH_I64, rows) ;
+	   th_int(&ob, &meta, 6, TH_I64, list->block[3*c + 2]) ;
+	   th_int(&ob, &meta, 7, TH_I64, list->block[3*c + 2]) ;
+	   th_int(&ob, &meta, 9, TH_I64, at + list->block[3*c + 1]) ;	/* data page */
+	   if (datatype == NOMINAL)
+		th_int(&ob, &meta, 11, TH_I64, at) ;		/* dictionary page */
+	   th_stop(&ob) ;
+	   th_stop(&ob) ;
+	   c++ ;
+	}
+	th_int(&ob, &group, 2, TH_I64, list->block[3*c - 1] + list->block[3*c - 3]
+		- list->block[3*g*columns]) ;			/* total_byte_size */
+	th_int(&ob, &group, 3, TH_I64, rows) ;
+	th_stop(&ob) ;
+   }
 
-			/* print the attribute's name */
-		    fprintf(stream, "%s", Data_Dictionary[j].name) ;
+   th_string(&ob, &last, 6, "datgen version " VERSION) ;	/* created_by */
+   th_stop(&ob) ;
 
-		    /* show that this was a masked attribute */
-		    if (Data_Dictionary[j].masked) fprintf(stream, "*" ) ;
+   at = ob.length ;
+   out_grow(&ob, 8L) ;
+   fb_put(&ob, ob.length, at, 4) ;
+   ob.length += 4 ;
+   out_text(&ob, "PAR1", 4, 0) ;
+   out_write(&ob) ;
 
-			if (Data_Dictionary[j].datatype == NOMINAL) {
-				char buffer[256] ;
-				
-				fprintf(stream, "=") ;
+   free(ob.text) ;
+}
 
-				if (debug) fprintf(stream, "%d", Term->setsize);
+/*****************************************************************************
+** npy_column()
+**
+** Describe the .npy column of attribute k, or of the class when k is
+** gen->attributes: its numpy type (<i1, <i2, <i4 or <f4, in host order)
+** and the bytes of one value. Returns the number of labels of a nominal
+** column and 0 otherwise.
+*****************************************************************************/
+long npy_column(struct Generator *gen, int k, char descr[4], int *width) {
+   int	datatype = k < gen->attributes ? gen->dictionary[k].datatype : NOMINAL ;
+   long	values = k < gen->attributes ? (long)gen->dictionary[k].dom_max : gen->classes + 1 ;
 
-			    /* add parentheses if this is a disjuntive term */
-			    if (Term->setsize > 1) fprintf(stream, "{") ;
+   *width = datatype == NOMINAL ? arrow_index_width(values) : 4 ;
+   sprintf(descr, "%c%c%d", host_big_endian() ? '>' : '<',
+	datatype == CONTINUOUS ? 'f' : 'i', *width) ;
 
-				/* for each value in the term's set */
-			    for (k=0,firstB=1; k<Term->setsize; k++) {
+   return(datatype == NOMINAL ? values : 0) ;
+}
 
-					if (firstB) firstB=!firstB ;
-					else fprintf(stream, "," ) ;
 
-					num2str(Term->nominal[k], buffer) ;
-					fprintf(stream,"%s", buffer ) ;
-				}
-				/* conclude the set if there were several values */
-			    if (Term->setsize > 1) fprintf(stream, "}" ) ;
-			}
-			
-			else if (Data_Dictionary[j].testtype == TWOSIDED) {
+/*****************************************************************************
+** json_string()
+**
+** Print text to stream as a quoted JSON string.
+*****************************************************************************/
+static void json_string(FILE *stream, char *text) {
 
-			   if (Data_Dictionary[j].datatype == ORDINAL) {
-				if (Term->setsize == 1)
-					fprintf(stream, "=%d", Term->ordinal[0]) ;
-				else
-					fprintf(stream, "=[%d,%d]", Term->ordinal[0], Term->ordinal[1] ) ;
-			   }
-			   else
-						fprintf(stream, "=[%g,%g]", Term->continuous[0], Term->continuous[1] ) ;
-			}
+   putc('"', stream) ;
+   for (; *text; text++) {
+	if (*text == '"' || *text == '\\') fprintf(stream, "\\%c", *text) ;
+	else if ((unsigned char)*text < 0x20) fprintf(stream, "\\u%04x", (unsigned char)*text) ;
+	else putc(*text, stream) ;
+   }
+   putc('"', stream) ;
+}
 
-			else if (Data_Dictionary[j].testtype == ONESIDED) {
+/*****************************************************************************
+** json_labels()
+**
+** Print the labels of the nominal attribute k, or of the class when k is
+** gen->attributes, to stream as a JSON array. Code c stands for label c.
+*****************************************************************************/
+static void json_labels(FILE *stream, struct Generator *gen, int k) {
+   long	values = k < gen->attributes ? (long)gen->dictionary[k].dom_max : gen->classes + 1 ;
+   long	v ;
+   char	label[32] ;
+
+   putc('[', stream) ;
+   for (v=0; v<values; v++) {
+	if (k < gen->attributes) json_string(stream, LABEL(v+1)) ;
+	else {
+	   sprintf(label, "c%ld", v) ;
+	   json_string(stream, label) ;
+	}
+	if (v < values-1) putc(',', stream) ;
+   }
+   putc(']', stream) ;
+}
 
-				if (Term->lessthan) {
-					fprintf(stream, "<=") ;
-					if (Data_Dictionary[j].datatype == ORDINAL)
-						fprintf(stream, "%d", Term->ordinal[1] ) ;
-					else
-						fprintf(stream, "%f", Term->continuous[1] ) ;
-				}
-				else {
-					fprintf(stream, ">=") ;
-					if (Data_Dictionary[j].datatype == ORDINAL)
-						fprintf(stream, "%d", Term->ordinal[0] ) ;
-					else
-						fprintf(stream, "%f", Term->continuous[0] ) ;
-				}
 
-			}
+/*****************************************************************************
+** npy_begin()
+**
+** Create the directory gen->path with a NAME.npy file per visible
+** attribute and for the class, each with its header and already at its
+** full size, so that every chunk can be written in place in any order.
+** The sidecar datgen.json lists the columns, their types, the value
+** that marks a missing value and the labels of the nominal codes.
+*****************************************************************************/
+void npy_begin(struct Generator *gen) {
+   struct Out_buffer	header ;
+   FILE		*json ;
+   char		file[1040], descr[4] ;
+   char		*name ;
+   long		values ;
+   int		k, width, first ;
+
+   if (mkdir(gen->path, 0777) != 0 && errno != EEXIST) {
+	fprintf(stderr, "ERROR: could not create the directory %s\n", gen->path) ;
+	fail(3) ;
+   }
 
-			else { /* ERROR */
-					fprintf(stderr, "ERROR: unknown condition 84792740 [%d][%d].\n",
-						Data_Dictionary[j].datatype, Data_Dictionary[j].testtype) ;
-					exit(3) ;
-				}
-			
-			
-			Term=Term->next_term ;
-		  }
+   sprintf(file, "%.1000s/datgen.json", gen->path) ;
+   if ((json = fopen(file, "w")) == NULL) {
+	fprintf(stderr, "ERROR: could not open %s\n", file) ;
+	fail(3) ;
+   }
+   fprintf(json, "{\n  \"objects\": %ld,\n  \"columns\": [", gen->objects) ;
+
+   header.size = 256 ;
+   header.text = (char *)malloc((size_t)header.size) ;
+
+   gen->columns = (int *)malloc((gen->attributes+1) * sizeof(int)) ;
+   for (k=0, first=1; k<=gen->attributes; k++) {
+
+	gen->columns[k] = -1 ;
+	if (k < gen->attributes && gen->dictionary[k].masked) continue ;
+	name   = k < gen->attributes ? gen->dictionary[k].name : class_name ;
+	values = npy_column(gen, k, descr, &width) ;
+
+	/* the header is padded with spaces to a multiple of 64 bytes */
+	header.length = 0 ;
+	out_text(&header, "\223NUMPY\001\000", 8, 0) ;
+	header.length += 2 ;
+	out_printf(&header, "{'descr': '%s', 'fortran_order': False, 'shape': (%ld,), }",
+		descr, gen->objects) ;
+	while ((header.length + 1) % 64) out_text(&header, " ", 1, 0) ;
+	out_text(&header, "", 0, '\n') ;
+	fb_put(&header, 8L, header.length - 10, 2) ;
+
+	sprintf(file, "%.1000s/%.20s.npy", gen->path, name) ;
+	gen->columns[k] = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0666) ;
+	if (gen->columns[k] < 0
+		|| ftruncate(gen->columns[k], (off_t)(header.length + gen->objects * width)) != 0
+		|| pwrite(gen->columns[k], header.text, (size_t)header.length, (off_t)0) != header.length) {
+	   fprintf(stderr, "ERROR: could not write %s\n", file) ;
+	   fail(3) ;
+	}
+	gen->column_start = header.length ;
+
+	fprintf(json, "%s\n    {\"name\": ", first ? "" : ",") ;
+	json_string(json, name) ;
+	fprintf(json, ", \"file\": ") ;
+	json_string(json, strrchr(file, '/') + 1) ;
+	fprintf(json, ", \"dtype\": \"%s\", ", descr) ;
+	first = 0 ;
+
+	if (k == gen->attributes)
+	   fprintf(json, "\"type\": \"class\", \"labels\": ") ;
+	else if (values)
+	   fprintf(json, "\"type\": \"nominal\", \"missing\": -1, \"labels\": ") ;
+	else if (gen->dictionary[k].datatype == ORDINAL)
+	   fprintf(json, "\"type\": \"ordinal\", \"missing\": %d}", INT_MIN) ;
+	else
+	   fprintf(json, "\"type\": \"continuous\", \"missing\": \"NaN\"}") ;
 
-		} /* for every term */
+	if (values) {
+	   json_labels(json, gen, k) ;
+	   putc('}', json) ;
+	}
+   }
+   fprintf(json, "\n  ]\n}\n") ;
 
+   if (fclose(json) != 0) {
+	fprintf(stderr, "ERROR: could not write %s/datgen.json\n", gen->path) ;
+	fail(3) ;
+   }
+   free(header.text) ;
+}
 
 
+/*****************************************************************************
+** npy_chunk()
+**
+** Write the objects of the batch, the first of which is object first,
+** in place into each column file. Nominal values become their codes
+** 0 .. dom_max-1 and -1 when missing; missing ORDINAL values are INT_MIN
+** and missing CONTINUOUS values NaN.
+*****************************************************************************/
+void npy_chunk(struct Generator *gen, struct Batch *batch, long first, struct Out_buffer *ob) {
+   long		rows = batch->rows, r ;
+   int		attributes = gen->attributes ;
+   int		k, width, code ;
+   unsigned int	nan_bits = 0x7FC00000U ;
+   float	x, nan ;
+   char		descr[4], *cell ;
 
+   memcpy(&nan, &nan_bits, 4) ;
 
-	    fprintf(stream, "\n" ) ;
-	  }
-	} /* foreach rule */
+   for (k=0; k<=attributes; k++) {
+	int	datatype = k < attributes ? gen->dictionary[k].datatype : NOMINAL ;
 
+	if (gen->columns[k] < 0) continue ;
+	npy_column(gen, k, descr, &width) ;
 
+	ob->length = 0 ;
+	out_grow(ob, rows * width) ;
+	for (r=0; r<rows; r++) {
+	   cell = ob->text + r*width ;
 
+	   if (k == attributes) code = batch->class[r] ;
+	   else {
+		x = batch->values[r*attributes + k] ;
+		if (datatype == CONTINUOUS) {
+		   if (x == MISSINGVAL) x = nan ;
+		   memcpy(cell, &x, 4) ;
+		   continue ;
+		}
+		if (x == MISSINGVAL) code = datatype == NOMINAL ? -1 : INT_MIN ;
+		else code = datatype == NOMINAL ? (int)x - 1 : (int)x ;
+	   }
 
+	   if (width == 1) { signed char c = (signed char)code ; memcpy(cell, &c, 1) ; }
+	   else if (width == 2) { short c = (short)code ; memcpy(cell, &c, 2) ; }
+	   else memcpy(cell, &code, 4) ;
+	}
 
+	if (pwrite(gen->columns[k], ob->text, (size_t)(rows * width),
+		(off_t)(gen->column_start + first * width)) != rows * width) {
+	   perror("ERROR: writing the column files") ;
+	   fail(3) ;
+	}
+   }
+}
 
-	
-	/* Conclude printin of rule base */
-	if (verbose) fprintf(stream, "\n\n") ;
-	fflush(stream) ;
-	if (rule_fd) fclose(rule_fd) ;
- 	if (debug) fprintf(stderr, "} Finished Rule Display %d\n", i);
 
-   } /* print rule base */
+/*****************************************************************************
+** npy_end()
+**
+** Close the column files.
+*****************************************************************************/
+void npy_end(struct Generator *gen) {
+   int	k ;
 
+   for (k=0; k<=gen->attributes; k++)
+	if (gen->columns[k] >= 0 && close(gen->columns[k]) != 0) {
+	   perror("ERROR: closing the column files") ;
+	   fail(3) ;
+	}
+   free(gen->columns) ;
+}
 
-   if (debug) fprintf(stderr, "\nAbout to exit\n", i);
 
+/*****************************************************************************
+** rows_field()
+**
+** Bytes of attribute k, or of the class when k is gen->attributes, in a
+** -t rows record: a float, or the unsigned codes of its values in as few
+** of 1, 2 or 4 bytes as they fit.
+*****************************************************************************/
+int rows_field(struct Generator *gen, int k) {
+   long	values ;
 
+   if (k == gen->attributes) values = gen->classes + 1 ;
+   else if (gen->dictionary[k].datatype == CONTINUOUS) return(4) ;
+   else if (gen->dictionary[k].datatype == NOMINAL) values = (long)gen->dictionary[k].dom_max ;
+   else values = (long)(gen->dictionary[k].dom_max - gen->dictionary[k].dom_min) + 1 ;
 
+   if (values <= 256) return(1) ;
+   if (values <= 65536) return(2) ;
+   return(4) ;
+}
 
-   exit(0) ;
 
-} /* end of main() */
+/*****************************************************************************
+** rows_begin()
+**
+** Lay out the fixed size record of -t rows and describe it in the sidecar
+** PATH.json. A record starts with a bitmask of the missing values, bit n
+** for the n-th visible attribute, then holds each visible attribute and
+** the class, unpadded and in host byte order: nominal values and the
+** class as the codes 0 .. dom_max-1, ordinal values as value - dom_min,
+** continuous values as floats. Object i is at i * record, so the file is
+** reserved at its full size and the chunks are written in any order.
+*****************************************************************************/
+void rows_begin(struct Generator *gen, struct Chunk_queue *q) {
+   FILE		*json ;
+   char		file[1040], *name ;
+   int		k, n, mask, offset ;
+
+   for (k=0, n=0; k<gen->attributes; k++)
+	if (! gen->dictionary[k].masked) n++ ;
+   mask = (n + 7) / 8 ;
+
+   gen->columns = (int *)malloc((gen->attributes+1) * sizeof(int)) ;
+   for (k=0, offset=mask; k<=gen->attributes; k++) {
+	gen->columns[k] = -1 ;
+	if (k < gen->attributes && gen->dictionary[k].masked) continue ;
+	gen->columns[k] = offset ;
+	offset += rows_field(gen, k) ;
+   }
+   gen->record = offset ;
 
+   sprintf(file, "%.1000s.json", gen->path) ;
+   if ((json = fopen(file, "w")) == NULL) {
+	fprintf(stderr, "ERROR: could not open %s\n", file) ;
+	fail(3) ;
+   }
+   fprintf(json, "{\n  \"objects\": %ld,\n  \"record_size\": %ld,\n  \"byte_order\": \"%s\",\n",
+	gen->objects, gen->record, host_big_endian() ? "big" : "little") ;
+   fprintf(json, "  \"missing_mask\": {\"offset\": 0, \"bytes\": %d},\n  \"columns\": [", mask) ;
+
+   for (k=0, n=0; k<=gen->attributes; k++) {
+	if (gen->columns[k] < 0) continue ;
+	name = k < gen->attributes ? gen->dictionary[k].name : class_name ;
+
+	fprintf(json, "%s\n    {\"name\": ", n ? "," : "") ;
+	json_string(json, name) ;
+	fprintf(json, ", \"offset\": %d, \"dtype\": \"%s%d\", ", gen->columns[k],
+		k < gen->attributes && gen->dictionary[k].datatype == CONTINUOUS ? "float" : "uint",
+		8 * rows_field(gen, k)) ;
+
+	if (k == gen->attributes) {
+	   fprintf(json, "\"type\": \"class\", \"labels\": ") ;
+	   json_labels(json, gen, k) ;
+	}
+	else if (gen->dictionary[k].datatype == NOMINAL) {
+	   fprintf(json, "\"type\": \"nominal\", \"missing_bit\": %d, \"labels\": ", n++) ;
+	   json_labels(json, gen, k) ;
+	}
+	else if (gen->dictionary[k].datatype == ORDINAL)
+	   fprintf(json, "\"type\": \"ordinal\", \"missing_bit\": %d, \"min\": %d", n++,
+		(int)gen->dictionary[k].dom_min) ;
+	else
+	   fprintf(json, "\"type\": \"continuous\", \"missing_bit\": %d", n++) ;
+	putc('}', json) ;
+   }
+   fprintf(json, "\n  ]\n}\n") ;
 
+   if (fclose(json) != 0) {
+	fprintf(stderr, "ERROR: could not write %s\n", file) ;
+	fail(3) ;
+   }
 
+   /* create_objects() cuts the file to q->written at the end */
+   q->written = gen->objects * gen->record ;
+   out_allocate(q, q->chunks - 1) ;
+}
 
 
+/*****************************************************************************
+** rows_chunk()
+**
+** Write the objects of the batch, the first of which is object first, as
+** records at their place in the -o file. A missing value has its bit set
+** in the mask and is stored as 0.
+*****************************************************************************/
+void rows_chunk(struct Generator *gen, struct Batch *batch, long first, struct Out_buffer *ob) {
+   long		rows = batch->rows, r ;
+   int		attributes = gen->attributes ;
+   int		k, n, width, datatype ;
+   unsigned int	code ;
+   float	x ;
+   char		*record, *cell ;
+
+   ob->length = 0 ;
+   out_grow(ob, rows * gen->record) ;
+   memset(ob->text, 0, (size_t)(rows * gen->record)) ;
+
+   for (r=0; r<rows; r++) {
+	record = ob->text + r * gen->record ;
+
+	for (k=0, n=0; k<=attributes; k++) {
+	   if (gen->columns[k] < 0) continue ;
+	   cell  = record + gen->columns[k] ;
+	   width = rows_field(gen, k) ;
+
+	   if (k == attributes) code = (unsigned int)batch->class[r] ;
+	   else {
+		datatype = gen->dictionary[k].datatype ;
+		x = batch->values[r*attributes + k] ;
+		if (x == MISSINGVAL) {
+		   record[n/8] |= (char)(1 << (n%8)) ;
+		   n++ ;
+		   continue ;
+		}
+		n++ ;
+		if (datatype == CONTINUOUS) {
+		   memcpy(cell, &x, 4) ;
+		   continue ;
+		}
+		code = (unsigned int)((int)x - (datatype == NOMINAL ? 1 : (int)gen->dictionary[k].dom_min)) ;
+	   }
 
+	   if (width == 1) { unsigned char c = (unsigned char)code ; memcpy(cell, &c, 1) ; }
+	   else if (width == 2) { unsigned short c = (unsigned short)code ; memcpy(cell, &c, 2) ; }
+	   else memcpy(cell, &code, 4) ;
+	}
+   }
 
+   ob->length = rows * gen->record ;
+   out_pwrite(ob, first * gen->record) ;
+}
 
 
 
@@ -2673,12 +6873,36 @@ int main(int argc, char *argv[])
 ******************************************************************
 *****************************************************************/
 
+/*************************************
+** Leave with the exit code: 1 when the domain is overconstrained, 2 for
+** a parameter problem, 3 otherwise. Inside a libdatgen call the call
+** returns the code instead.
+*************************************/
+void fail(int code)
+{
+	jmp_buf	*env = failure_keyed ? (jmp_buf *)pthread_getspecific(failure_key) : NULL ;
+
+	if (env != NULL) longjmp(*env, code) ;
+	exit(code) ;
+}
+
+
+/*************************************
+** The thread key fail() finds its way back by.
+*************************************/
+void failure_key_create()
+{
+	pthread_key_create(&failure_key, NULL) ;
+	failure_keyed = 1 ;
+}
+
+
 /*************************************
 ** Compare the number of objects of two rules.
 *************************************/
 int compare_rule_freq(struct CNF_Rule *i, struct CNF_Rule *j)
 {
-        return (j->objects - i->objects);
+        return (j->objects > i->objects) - (j->objects < i->objects);
 }
 
 
@@ -2692,12 +6916,37 @@ int compare_int(int *i, int *j)
 }
 
 
+/*************************************
+** Count the bits set in a word.
+*************************************/
+int bit_count(unsigned long x)
+{
+        int n ;
+
+        for (n=0; x; n++) x &= x - 1 ;
+        return (n);
+}
+
+
+/*************************************
+** Do two value bitsets share a value?
+*************************************/
+int sets_overlap(unsigned long *a, unsigned long *b, int words)
+{
+        int w ;
+
+        for (w=0; w<words; w++)
+                if (a[w] & b[w]) return (1);
+        return (0);
+}
+
+
 /*************************************
 ** Compare two real numbers.
 *************************************/
-float compare_float(float *i, float *j)
+int compare_float(float *i, float *j)
 {
-        return (*i - *j);
+        return ((*i > *j) - (*i < *j));
 }
 
 
@@ -2764,6 +7013,146 @@ double sn_rand() {
    return(val) ;
 
 }
+
+
+/*****************************************************************************
+** rand_seek()
+**
+** Position a stream at the start of the draws for (object index, retry).
+** Streams in drand48() mode ignore the position and keep their sequence.
+*****************************************************************************/
+void rand_seek(struct Rand_stream *rs, long index, long retry) {
+
+   if (! rs->counter) return ;
+
+   rs->ctr[0] = 0 ;
+   rs->ctr[1] = (unsigned long)retry & 0xFFFFFFFFUL ;
+   rs->ctr[2] = (unsigned long)index & 0xFFFFFFFFUL ;
+   rs->ctr[3] = ((unsigned long)index >> 16 >> 16) & 0xFFFFFFFFUL ;
+   rs->used   = 4 ; /* force a new block on the next draw */
+}
+
+
+/*****************************************************************************
+** mul_hilo()
+**
+** 32x32 -> 64 bit product split into high and low words: one product
+** where longs are 64 bits, otherwise on 16 bit halves because ANSI C only
+** promises 32 bit longs.
+*****************************************************************************/
+#if ULONG_MAX > 0xFFFFFFFFUL
+static void mul_hilo(unsigned long a, unsigned long b,
+		unsigned long *hi, unsigned long *lo) {
+   unsigned long p = a * b ;
+
+   *lo = p & 0xFFFFFFFFUL ;
+   *hi = p >> 32 ;
+}
+#else
+static void mul_hilo(unsigned long a, unsigned long b,
+		unsigned long *hi, unsigned long *lo) {
+   unsigned long a0 = a & 0xFFFFUL, a1 = a >> 16 ;
+   unsigned long b0 = b & 0xFFFFUL, b1 = b >> 16 ;
+   unsigned long p00 = a0*b0, p01 = a0*b1, p10 = a1*b0, p11 = a1*b1 ;
+   unsigned long mid ;
+
+   mid = (p00 >> 16) + (p01 & 0xFFFFUL) + (p10 & 0xFFFFUL) ;
+   *lo = ((mid << 16) | (p00 & 0xFFFFUL)) & 0xFFFFFFFFUL ;
+   *hi = (p11 + (p01 >> 16) + (p10 >> 16) + (mid >> 16)) & 0xFFFFFFFFUL ;
+}
+#endif
+
+
+/*****************************************************************************
+** rand_block()
+**
+** Encrypt the stream's counter with Philox4x32-10 to get four fresh words.
+** Based on "Parallel Random Numbers: As Easy as 1, 2, 3" Salmon et al. (2011)
+*****************************************************************************/
+void rand_block(struct Rand_stream *rs) {
+   unsigned long ctr[4], key[2] ;
+   unsigned long hi0, lo0, hi1, lo1 ;
+   int round ;
+
+   ctr[0] = rs->ctr[0] ; ctr[1] = rs->ctr[1] ;
+   ctr[2] = rs->ctr[2] ; ctr[3] = rs->ctr[3] ;
+   key[0] = rs->key[0] ; key[1] = rs->key[1] ;
+
+   for (round=0; round<PHILOX_ROUNDS; round++) {
+	mul_hilo(PHILOX_M0, ctr[0], &hi0, &lo0) ;
+	mul_hilo(PHILOX_M1, ctr[2], &hi1, &lo1) ;
+
+	ctr[0] = hi1 ^ ctr[1] ^ key[0] ;
+	ctr[1] = lo1 ;
+	ctr[2] = hi0 ^ ctr[3] ^ key[1] ;
+	ctr[3] = lo0 ;
+
+	key[0] = (key[0] + PHILOX_W0) & 0xFFFFFFFFUL ;
+	key[1] = (key[1] + PHILOX_W1) & 0xFFFFFFFFUL ;
+   }
+
+   rs->block[0] = ctr[0] ; rs->block[1] = ctr[1] ;
+   rs->block[2] = ctr[2] ; rs->block[3] = ctr[3] ;
+   rs->used = 0 ;
+
+   /* the next block of this (object, retry) */
+   rs->ctr[0] = (rs->ctr[0] + 1) & 0xFFFFFFFFUL ;
+}
+
+
+/*************************************
+** Return a random real over interval [0.0, 1.0) from a stream
+*************************************/
+double n_rand_r(struct Rand_stream *rs) {
+   unsigned long a, b ;
+
+   if (! rs->counter) return(drand48()) ;
+
+   if (rs->used >= 4) rand_block(rs) ;
+
+   /* 27 + 26 bits give every double in [0,1) a chance */
+   a = rs->block[rs->used++] >> 5 ;
+   b = rs->block[rs->used++] >> 6 ;
+   return((a*67108864.0 + b) / 9007199254740992.0) ;
+}
+
+
+/***************************************
+** Return a random integer y in [0,x) from a stream
+***************************************/
+int int_rand_r(struct Rand_stream *rs, int x) {
+	double y=0 ;
+
+	y = n_rand_r(rs) ;
+	y *= x ;
+	return((int)y) ;
+}
+
+
+/*****************************************************************************
+** sn_rand_r()
+**
+** sn_rand() drawing from a stream.
+*****************************************************************************/
+double sn_rand_r(struct Rand_stream *rs) {
+   double	v1, v2 ;
+   double	r, fac, val ;
+
+   v1 = fabs(2*n_rand_r(rs) - 1) ;
+   v2 = fabs(2*n_rand_r(rs) - 1) ;
+   r =  pow(v1,2.0) + pow(v2,2.0) ;
+   while (r >= 1.0) {
+	v1=fabs(2*n_rand_r(rs) - 1) ;
+	v2=fabs(2*n_rand_r(rs) - 1) ;
+	r=pow(v1,2.0)+pow(v2,2.0) ;
+   }
+
+   fac = sqrt(-2 * log(r)/r) ;
+   val = v1 * fac / 2.5 ;
+   val = val - floor(val) ;
+   return(val) ;
+
+}
 	
 
 /*****************************************************************************
@@ -2771,7 +7160,7 @@ double sn_rand() {
 **
 ** Convert a number to a string using the mapping below
 **
-** BUG: tokens with more than 5 characters will not follow the sequence.
+** Returns the length of the string.
 **
 *****************************************************************************/
 /*
@@ -2796,65 +7185,62 @@ double sn_rand() {
 */
 
 int num2str(int number, char buffer[256]) {
-   int  	i		; /* digit counter */
-   int  	digit		; /* value 0 is digit #1 */
-   float	digitorder	; /* order of digit. in decimal the 3rd digit has order 100 */
-   int  	digitvalue	;
-   int  	workingnum=number	;
-   float	fdigits	;
-   int  	adj1,adj2,adj3,adj4 ;
-
-   /* if (debug) fprintf(stderr, "debug: num2str(%d,%d)\n", number, buffer) ; */
-
-   /* Adjusts for the transition from z to aa */
-   /* Similar to the transition from 9 to 11 instead of 9 to 10 */
-   /* Do this by adding the right amount as the number given gets bigger */
-   /* BUG: Only 4 adjustments are made. */
-   adj1 = (int)(number-1)/(26) ;
-   adj2 = 27*(int)((number-1-26)/(26*26)) ;
-   if (adj2<0) adj2=0 ;
-   adj3 = 27*27*(int)((number-1-26-26*26)/(26*26*26)) ;
-   if (adj3<0) adj3=0 ;
-   adj4 = 27*27*27*(int)((number-1-26-26*26-26*26*26)/(26*26*26*26)) ;
-   if (adj4<0) adj4=0 ;
+   char	reversed[16] ;
+   int	i, n ;
 
-   /* debug printf("adj1=%d adj2=%d adj3=%d adj4=%d\n", adj1, adj2, adj3, adj4) ; */
+   /* like counting in base 26 without a zero: z is followed by aa */
+   for (n=0; number > 0; number=(number-1)/26)
+	reversed[n++] = (char)('a' + (number-1)%26) ;
 
-   workingnum = number + adj1 + adj2 + adj3 + adj4 ;
+   for (i=0; i<n; i++) buffer[i] = reversed[n-1-i] ;
 
-   fdigits = (float)(log(workingnum)/log('z'-'a'+2)) ; /* how many digits */
-
-   digit = (int)fdigits ; /* point to the first digit */
-
-   /* process each digit */
-   i=0 ;
-   while(i<=fdigits) {
-
-	digitorder = (float)pow(27,digit) ;
-
-	/* calculate the value of this digit */
-	digitvalue = (int)(workingnum/digitorder) ;
-
-      /* 
-	if (debug) printf("working %d digit %d, order %3.1f, value %d i %d\n",
-		workingnum, digit, digitorder, digitvalue, i) ;
-      */
-
-	buffer[i]='a'+(digitvalue-1) ;
-
-	/* calculate the remainder */
-	workingnum = workingnum - (int)(digitvalue*digitorder) ;
+   /* terminate the string */
+   buffer[n]=(char)0 ;
 
-	/* move on to the next digit */
-	digit-- ;
-	i++ ;
+   return(n) ;
+}
 
-   } /* for each digit */
 
+/*****************************************************************************
+** build_labels()
+**
+** Render the labels of the values 1 .. the largest nominal domain once,
+** each followed by its terminating 0, so that printing a nominal value
+** is a lookup: LABEL(v) is the string and LABEL_LENGTH(v) its length.
+** The labels do not depend on the generator, so the table only grows:
+** the generators the server keeps all print with the one table.
+*****************************************************************************/
+void build_labels(struct Attribute_def *Data_Dictionary, int attributes) {
+   char	buffer[256] ;
+   long	size ;
+   int	k, v, values = 0 ;
+
+   for (k=0; k<attributes; k++)
+	if (Data_Dictionary[k].datatype == NOMINAL && (int)Data_Dictionary[k].dom_max > values)
+	   values = (int)Data_Dictionary[k].dom_max ;
+   if (Labels.text != NULL && values <= Labels.values) return ;
+
+   free(Labels.start) ;
+   free(Labels.text) ;
+   Labels.values = values ;
+
+   Labels.start = (long *)malloc((Labels.values+2) * sizeof(long)) ;
+   size = 16L * (Labels.values+1) ;
+   Labels.text  = (char *)malloc((size_t)size) ;
+   if (Labels.start == NULL || Labels.text == NULL) {
+	fprintf(stderr, "ERROR: out of memory for %d nominal labels\n", Labels.values) ;
+	fail(3) ;
+   }
 
-   /* terminate the string */
-   buffer[i]=(char)0 ;
+   /* value 0 is not used; it gets an empty label */
+   Labels.start[0] = 0 ;
+   Labels.text[0]  = 0 ;
+   Labels.start[1] = 1 ;
+   for (v=1; v<=Labels.values; v++) {
+	int length = num2str(v, buffer) ;
 
-   return(0) ;
+	memcpy(Labels.text + Labels.start[v], buffer, (size_t)length+1) ;
+	Labels.start[v+1] = Labels.start[v] + length + 1 ;
+   }
 }
 
@@ -0,0 +1,93 @@
+/*****************************************************************
+** libdatgen: DatGen inside another program.                    **
+**                                                              **
+** make libdatgen.a, then link with -ldatgen -lm -lpthread -lz. **
+**                                                              **
+** A generator is built once from a config that mirrors the     **
+** datgen options, then fills the caller's column buffers, one  **
+** per visible attribute and one for the class, batch by batch. **
+** Object i depends only on the seed and i (as with -k), so     **
+** datgen_seek() reaches any object at once and the objects do  **
+** not depend on the batch sizes. datgen_clone() gives another  **
+** generator on the same rule base, for another thread to fill  **
+** a different slice of the objects with.                       **
+**                                                              **
+** Every call returns DATGEN_OK or one of the datgen exit       **
+** codes, and a failed datgen_open() frees what it had built.   **
+** Error messages still go to stderr.                           **
+**                                                              **
+** Building a generator is not reentrant: it reads the config   **
+** with getopt() and strtok(), draws the rule base from the     **
+** drand48() sequence and grows the process wide table of       **
+** nominal labels. Calls of datgen_open(), datgen_clone() and   **
+** datgen_close() must not overlap. Distinct generators may     **
+** fill their batches in parallel threads.                      **
+*****************************************************************/
+
+#ifndef DATGEN_H
+#define DATGEN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define	DATGEN_OK           0
+#define	DATGEN_CONSTRAINED  1	/* the domain is possibly overconstrained */
+#define	DATGEN_PARAMETER    2	/* parameter problem */
+#define	DATGEN_ERROR        3	/* other error */
+
+/* Column types, and the values a batch holds for them */
+#define	DATGEN_NOMINAL      1	/* int codes 0 .. values-1, -1 when missing */
+#define	DATGEN_ORDINAL      2	/* int min .. max, INT_MIN when missing */
+#define	DATGEN_CONTINUOUS   3	/* float min .. max, NaN when missing */
+#define	DATGEN_CLASS        4	/* int codes 0 .. values-1 */
+
+#define	DATGEN_LABEL_MAX    32	/* bytes of a label, see datgen_label() */
+
+struct datgen ;
+
+struct datgen_config {
+  /* datgen_config_init() sets the datgen defaults */
+  int    relevant ;		/* -A: relevant attributes */
+  int    irrelevant ;		/* -I: irrelevant attributes */
+  int    masked ;		/* -M: masked relevant attributes */
+  int    rules ;		/* -R: rules */
+  float  domain[2] ;		/* -d: min and max domain size */
+  int    conjuncts[2] ;		/* -C: conjunctions per rule component */
+  int    disjuncts[2] ;		/* -D: disjunctions per rule */
+  float  term[2] ;		/* -T: disjunctions per attribute term */
+  int    rule_distribution ;	/* -r: 0 uniform, 1 random, 2 normal */
+  float  default_rule ;		/* -F */
+  float  missing ;		/* -m */
+  float  attribute_errors ;	/* -e */
+  float  class_errors ;		/* -g */
+  const char *attribute_spec ;	/* -X, or NULL */
+  const char *class_name ;	/* -P, or NULL */
+  int    deferred ;		/* -l */
+  int    quiet ;		/* -q: no message for DATGEN_CONSTRAINED */
+  unsigned long seed ;		/* -s */
+} ;
+
+struct datgen_column {
+  const char *name ;
+  int    type ;			/* DATGEN_NOMINAL ... DATGEN_CLASS */
+  long   values ;		/* NOMINAL, CLASS: number of codes */
+  float  min ;			/* ORDINAL, CONTINUOUS: domain */
+  float  max ;
+} ;
+
+void    datgen_config_init(struct datgen_config *config) ;
+int     datgen_open(const struct datgen_config *config, struct datgen **generator) ;
+int     datgen_clone(struct datgen *generator, struct datgen **copy) ;
+int     datgen_columns(struct datgen *generator) ;
+int     datgen_column(struct datgen *generator, int column, struct datgen_column *info) ;
+int     datgen_label(struct datgen *generator, int column, int code, char label[DATGEN_LABEL_MAX]) ;
+int     datgen_seek(struct datgen *generator, long object) ;
+int     datgen_fill_batch(struct datgen *generator, long n, void *columns[]) ;
+void    datgen_close(struct datgen *generator) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DATGEN_H */
@@ -46,6 +46,22 @@ def generate_test_function(test_spec, suite_name):
         test_body = generate_performance_test(test_spec)
     elif test_type == 'shape_check':
         test_body = generate_shape_test(test_spec)
+    elif test_type == 'chunks_survive_other_generators':
+        test_body = generate_live_generators_test(test_spec)
+    elif test_type == 'chunks_concatenate':
+        test_body = generate_chunks_test(test_spec)
+    elif test_type == 'categories_match_labels':
+        test_body = generate_categories_test(test_spec)
+    elif test_type == 'identical_across_threads':
+        test_body = generate_threads_test(test_spec)
+    elif test_type == 'same_output':
+        test_body = generate_program_test(test_spec, generate_same_output_check(test_spec))
+    elif test_type == 'parts_match':
+        test_body = generate_program_test(test_spec, generate_parts_check(test_spec))
+    elif test_type == 'readback':
+        test_body = generate_program_test(test_spec, generate_readback_check(test_spec))
+    elif test_type == 'line_count':
+        test_body = generate_program_test(test_spec, generate_line_count_check(test_spec))
     else:
         test_body = generate_basic_test(test_spec)
 
@@ -206,6 +222,216 @@ assert df.shape == ({params['n']}, {params['m']} + 1), \\
 
     return '\n'.join(test_lines)
 
+def classic_args(params):
+    """The DatGenClassic keywords of a spec's params"""
+    args = (f"n_samples={params['n']}, n_features={params['m']}, n_classes={params['c']}, "
+            f"random_state={params.get('seed', 'None')}")
+    if 'domain_size' in params:
+        args += f", domain_size={params['domain_size']}"
+    return args
+
+CORE_REQUIRED = '''
+from datgen import classic
+if classic._core is None:
+    pytest.skip("datgen._core is not built")
+'''
+
+def generate_live_generators_test(spec):
+    """Generate test that chunked generators outlive other rule bases"""
+    params = spec['params']
+    expected = spec['expected']
+    other = expected['other']
+    between = expected['built_between']
+
+    return CORE_REQUIRED + f'''
+gen = DatGenClassic({classic_args(params)})
+expected = gen.generate()
+chunks = gen.generate_chunks({params['chunk_size']})
+first = next(chunks)
+
+other = DatGenClassic({classic_args(other)})
+other_expected = other.generate()
+other_chunks = other.generate_chunks({other['chunk_size']})
+other_first = next(other_chunks)
+
+# a rule base built last, then freed, in between
+DatGenClassic({classic_args(between)}).generate()
+
+pd.testing.assert_frame_equal(pd.concat([first] + list(chunks)), expected)
+pd.testing.assert_frame_equal(pd.concat([other_first] + list(other_chunks)), other_expected)
+'''
+
+def generate_chunks_test(spec):
+    """Generate test that the chunks concatenate to the dataset"""
+    params = spec['params']
+    expected = spec['expected']
+
+    return CORE_REQUIRED + f'''
+for data_type in {expected['data_types']!r}:
+    gen = DatGenClassic({classic_args(params)}, data_type=data_type)
+    expected = gen.generate()
+    for chunk_size in {expected['chunk_sizes']!r}:
+        chunks = list(gen.generate_chunks(chunk_size))
+        assert len(chunks) == -(-{params['n']} // chunk_size)
+        assert all(len(chunk) <= chunk_size for chunk in chunks)
+        pd.testing.assert_frame_equal(pd.concat(chunks), expected)
+'''
+
+def generate_categories_test(spec):
+    """Generate test that the categories are the C labels, with or without C"""
+    params = spec['params']
+    classes = [f'c{i}' for i in range(1, params['c'] + 1)]
+
+    return CORE_REQUIRED + f'''
+gen = DatGenClassic({classic_args(params)})
+df = gen.generate()
+generator = gen._open_generator()
+for c, (_, kind, values, _, _) in enumerate(generator.columns()[:-1]):
+    labels = [generator.label(c, code) for code in range(values)]
+    assert list(df.iloc[:, c].cat.categories) == labels
+assert list(df['class'].cat.categories) == {classes!r}
+assert df['class'].notna().all()
+
+# the Python approximation declares the same categories
+core, classic._core = classic._core, None
+try:
+    fallback = DatGenClassic({classic_args(params)}).generate()
+finally:
+    classic._core = core
+assert list(fallback.dtypes) == list(df.dtypes)
+'''
+
+def generate_threads_test(spec):
+    """Generate test that the frames do not depend on the threads filling them"""
+    params = spec['params']
+    expected = spec['expected']
+
+    return CORE_REQUIRED + f'''
+from unittest import mock
+
+for data_type in {expected['data_types']!r}:
+    frames = []
+    for threads in {expected['threads']!r}:
+        with mock.patch.object(classic, 'OBJECTS_PER_THREAD', {expected['objects_per_thread']}), \\
+             mock.patch.object(classic.os, 'cpu_count', return_value=threads):
+            gen = DatGenClassic({classic_args(params)}, data_type=data_type)
+            assert len(gen._generators(gen.n_samples)) == threads
+            frames.append(gen.generate())
+    for df in frames[1:]:
+        pd.testing.assert_frame_equal(frames[0], df)
+'''
+
+def generate_program_test(spec, check):
+    """Generate test that runs the C datgen of src/, built with make
+
+    The commands run in src/ through the shell, {tmp} standing for a
+    temporary directory of the test.
+    """
+    return '''
+import json
+import tempfile
+
+src = Path(__file__).resolve().parents[2] / 'src'
+if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+    pytest.skip("src/datgen does not build")
+
+def run(command, tmp):
+    result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+    assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+    return result.stdout
+
+with tempfile.TemporaryDirectory() as tmp:
+''' + indent(check, '    ')
+
+def generate_same_output_check(spec):
+    """Check that the commands print the same bytes"""
+    commands = spec['commands']
+
+    return f'''
+outputs = [run(command, tmp) for command in {commands!r}]
+assert len(outputs[0]) > 0, "no output"
+for command, output in zip({commands[1:]!r}, outputs[1:]):
+    assert output == outputs[0], f"{{command}} differs from {commands[0]}"
+'''
+
+def generate_parts_check(spec):
+    """Check that the -S parts concatenate to the reference and match the manifest"""
+    expected = spec['expected']
+
+    return f'''
+run({spec['command']!r}, tmp)
+reference = run({spec['reference']!r}, tmp)
+parts = Path(tmp) / {expected['directory']!r}
+manifest = json.loads((parts / 'manifest.json').read_text())
+files = sorted(parts.glob('part-*'))
+assert [f.name for f in files] == [part['file'] for part in manifest['parts']]
+assert len(files) == {expected['parts']}
+assert manifest['objects'] == sum(part['objects'] for part in manifest['parts']) == {expected['objects']}
+assert sum(rule['objects'] for rule in manifest['rules']) == {expected['objects']}
+assert b''.join(f.read_bytes() for f in files) == reference
+'''
+
+# Code reading the output of each -t format at path into rows of strings
+READERS = {
+    'arrow': '''
+pa = pytest.importorskip('pyarrow')
+table = pa.ipc.open_file(path).read_all()
+rows = [list(row) for row in zip(*(column.to_pylist() for column in table.columns))]
+''',
+    'arrows': '''
+pa = pytest.importorskip('pyarrow')
+table = pa.ipc.open_stream(path).read_all()
+rows = [list(row) for row in zip(*(column.to_pylist() for column in table.columns))]
+''',
+    'parquet': '''
+pq = pytest.importorskip('pyarrow.parquet')
+table = pq.read_table(path)
+rows = [list(row) for row in zip(*(column.to_pylist() for column in table.columns))]
+''',
+    'npy': '''
+layout = json.loads((Path(path) / 'datgen.json').read_text())
+columns = [[column['labels'][code] for code in np.load(Path(path) / column['file'])]
+           for column in layout['columns']]
+rows = [list(row) for row in zip(*columns)]
+''',
+    'rows': '''
+layout = json.loads(Path(path + '.json').read_text())
+records = np.fromfile(path, np.uint8).reshape(layout['objects'], layout['record_size'])
+order = '<' if layout['byte_order'] == 'little' else '>'
+columns = []
+for column in layout['columns']:
+    dtype = np.dtype(column['dtype']).newbyteorder(order)
+    codes = records[:, column['offset']:column['offset'] + dtype.itemsize].copy().view(dtype).ravel()
+    columns.append([column['labels'][code] for code in codes])
+rows = [list(row) for row in zip(*columns)]
+''',
+}
+
+def generate_readback_check(spec):
+    """Check that a binary format reads back as the text output (nominal data)"""
+    expected = spec['expected']
+
+    return f'''
+run({spec['command']!r}, tmp)
+reference = [line.split('\\t') for line in run({spec['reference']!r}, tmp).decode().splitlines()]
+path = str(Path(tmp) / {expected['path']!r})
+''' + READERS[expected['format']] + f'''
+assert len(rows) == len(reference) == {expected['objects']}
+assert rows == reference
+'''
+
+def generate_line_count_check(spec):
+    """Check the number of lines a stream prints"""
+    expected = spec['expected']
+
+    return f'''
+start = time.time()
+lines = run({spec['command']!r}, tmp).count(b'\\n')
+elapsed = time.time() - start
+assert {expected['min_lines']} <= lines <= {expected['max_lines']}, f"{{lines}} lines"
+assert elapsed < {expected['max_seconds']}, f"{{elapsed:.1f}}s"
+'''
+
 def generate_basic_test(spec):
     """Generate a basic test when type is not specified"""
     params = spec.get('params', {})
@@ -0,0 +1,122 @@
+"""
+Auto-generated pytest file for core tests
+Generated from test_manifest.yaml
+DO NOT EDIT MANUALLY - regenerate with: python generate_tests.py
+"""
+
+import pytest
+import pandas as pd
+import numpy as np
+from pathlib import Path
+import time
+import subprocess
+import sys
+
+# Import the module to test (will be implemented)
+try:
+    from datgen.classic import DatGenClassic
+except ImportError:
+    # Module not yet implemented - tests will fail
+    class DatGenClassic:
+        def __init__(self, **kwargs):
+            raise NotImplementedError("DatGenClassic not yet implemented")
+        def generate(self):
+            raise NotImplementedError("generate() not yet implemented")
+
+@pytest.mark.p1
+@pytest.mark.critical
+def test_k001_independent_live_generators():
+    """Test K001: Independent live generators"""
+
+    from datgen import classic
+    if classic._core is None:
+        pytest.skip("datgen._core is not built")
+
+    gen = DatGenClassic(n_samples=300, n_features=6, n_classes=3, random_state=1)
+    expected = gen.generate()
+    chunks = gen.generate_chunks(100)
+    first = next(chunks)
+
+    other = DatGenClassic(n_samples=50, n_features=12, n_classes=9, random_state=3)
+    other_expected = other.generate()
+    other_chunks = other.generate_chunks(25)
+    other_first = next(other_chunks)
+
+    # a rule base built last, then freed, in between
+    DatGenClassic(n_samples=50, n_features=2, n_classes=2, random_state=2, domain_size=3).generate()
+
+    pd.testing.assert_frame_equal(pd.concat([first] + list(chunks)), expected)
+    pd.testing.assert_frame_equal(pd.concat([other_first] + list(other_chunks)), other_expected)
+
+
+
+@pytest.mark.p1
+@pytest.mark.critical
+def test_k002_chunks_concatenate_to_the_dataset():
+    """Test K002: Chunks concatenate to the dataset"""
+
+    from datgen import classic
+    if classic._core is None:
+        pytest.skip("datgen._core is not built")
+
+    for data_type in ['categorical', 'continuous']:
+        gen = DatGenClassic(n_samples=1000, n_features=6, n_classes=3, random_state=5, data_type=data_type)
+        expected = gen.generate()
+        for chunk_size in [1, 7, 256, 1000, 5000]:
+            chunks = list(gen.generate_chunks(chunk_size))
+            assert len(chunks) == -(-1000 // chunk_size)
+            assert all(len(chunk) <= chunk_size for chunk in chunks)
+            pd.testing.assert_frame_equal(pd.concat(chunks), expected)
+
+
+
+@pytest.mark.p1
+@pytest.mark.critical
+def test_k003_categories_are_the_c_labels():
+    """Test K003: Categories are the C labels"""
+
+    from datgen import classic
+    if classic._core is None:
+        pytest.skip("datgen._core is not built")
+
+    gen = DatGenClassic(n_samples=500, n_features=4, n_classes=5, random_state=11, domain_size=30)
+    df = gen.generate()
+    generator = gen._open_generator()
+    for c, (_, kind, values, _, _) in enumerate(generator.columns()[:-1]):
+        labels = [generator.label(c, code) for code in range(values)]
+        assert list(df.iloc[:, c].cat.categories) == labels
+    assert list(df['class'].cat.categories) == ['c1', 'c2', 'c3', 'c4', 'c5']
+    assert df['class'].notna().all()
+
+    # the Python approximation declares the same categories
+    core, classic._core = classic._core, None
+    try:
+        fallback = DatGenClassic(n_samples=500, n_features=4, n_classes=5, random_state=11, domain_size=30).generate()
+    finally:
+        classic._core = core
+    assert list(fallback.dtypes) == list(df.dtypes)
+
+
+
+@pytest.mark.p1
+@pytest.mark.critical
+def test_k004_same_frames_across_runs_and_threads():
+    """Test K004: Same frames across runs and threads"""
+
+    from datgen import classic
+    if classic._core is None:
+        pytest.skip("datgen._core is not built")
+
+    from unittest import mock
+
+    for data_type in ['categorical', 'continuous']:
+        frames = []
+        for threads in [1, 1, 3, 8]:
+            with mock.patch.object(classic, 'OBJECTS_PER_THREAD', 64), \
+                 mock.patch.object(classic.os, 'cpu_count', return_value=threads):
+                gen = DatGenClassic(n_samples=2000, n_features=8, n_classes=4, random_state=7, data_type=data_type)
+                assert len(gen._generators(gen.n_samples)) == threads
+                frames.append(gen.generate())
+        for df in frames[1:]:
+            pd.testing.assert_frame_equal(frames[0], df)
+
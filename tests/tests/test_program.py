@@ -0,0 +1,347 @@
+"""
+Auto-generated pytest file for program tests
+Generated from test_manifest.yaml
+DO NOT EDIT MANUALLY - regenerate with: python generate_tests.py
+"""
+
+import pytest
+import pandas as pd
+import numpy as np
+from pathlib import Path
+import time
+import subprocess
+import sys
+
+# Import the module to test (will be implemented)
+try:
+    from datgen.classic import DatGenClassic
+except ImportError:
+    # Module not yet implemented - tests will fail
+    class DatGenClassic:
+        def __init__(self, **kwargs):
+            raise NotImplementedError("DatGenClassic not yet implemented")
+        def generate(self):
+            raise NotImplementedError("generate() not yet implemented")
+
+@pytest.mark.p1
+@pytest.mark.critical
+def test_d001_threads_do_not_change_the_output():
+    """Test D001: Threads do not change the output"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        outputs = [run(command, tmp) for command in ['./datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -k', './datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -j1', './datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -j4']]
+        assert len(outputs[0]) > 0, "no output"
+        for command, output in zip(['./datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -j1', './datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -j4'], outputs[1:]):
+            assert output == outputs[0], f"{command} differs from ./datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -k"
+
+
+
+@pytest.mark.p1
+@pytest.mark.critical
+def test_d002_a_range_is_a_slice_of_the_full_run():
+    """Test D002: A range is a slice of the full run"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        outputs = [run(command, tmp) for command in ['./datgen -R5 -A6 -I2 -d5/10 -s3 -O 5000 -i 1200:1800', "./datgen -R5 -A6 -I2 -d5/10 -s3 -O 5000 -k | sed -n '1201,1800p'"]]
+        assert len(outputs[0]) > 0, "no output"
+        for command, output in zip(["./datgen -R5 -A6 -I2 -d5/10 -s3 -O 5000 -k | sed -n '1201,1800p'"], outputs[1:]):
+            assert output == outputs[0], f"{command} differs from ./datgen -R5 -A6 -I2 -d5/10 -s3 -O 5000 -i 1200:1800"
+
+
+
+@pytest.mark.p1
+@pytest.mark.critical
+def test_d003_an_endless_stream_starts_as_the_full_run():
+    """Test D003: An endless stream starts as the full run"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        outputs = [run(command, tmp) for command in ['./datgen -R5 -A6 -I2 -d5/10 -s3 -O inf -k | head -n 3000', './datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -k']]
+        assert len(outputs[0]) > 0, "no output"
+        for command, output in zip(['./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -k'], outputs[1:]):
+            assert output == outputs[0], f"{command} differs from ./datgen -R5 -A6 -I2 -d5/10 -s3 -O inf -k | head -n 3000"
+
+
+
+@pytest.mark.p1
+@pytest.mark.critical
+def test_d004_gzip_members_concatenate_to_the_text_output():
+    """Test D004: Gzip members concatenate to the text output"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        outputs = [run(command, tmp) for command in ['./datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -j4 -Z gzip:6 | gzip -dc', './datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -j4 -Z gzip -o {tmp}/out.tsv.gz && zcat {tmp}/out.tsv.gz', './datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -j4']]
+        assert len(outputs[0]) > 0, "no output"
+        for command, output in zip(['./datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -j4 -Z gzip -o {tmp}/out.tsv.gz && zcat {tmp}/out.tsv.gz', './datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -j4'], outputs[1:]):
+            assert output == outputs[0], f"{command} differs from ./datgen -R5 -A6 -I2 -d5/10 -s3 -O 20000 -j4 -Z gzip:6 | gzip -dc"
+
+
+
+@pytest.mark.p1
+@pytest.mark.critical
+def test_d005_parts_and_manifest():
+    """Test D005: Parts and manifest"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 5000 -k -S 700 -o {tmp}/parts', tmp)
+        reference = run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 5000 -k', tmp)
+        parts = Path(tmp) / 'parts'
+        manifest = json.loads((parts / 'manifest.json').read_text())
+        files = sorted(parts.glob('part-*'))
+        assert [f.name for f in files] == [part['file'] for part in manifest['parts']]
+        assert len(files) == 8
+        assert manifest['objects'] == sum(part['objects'] for part in manifest['parts']) == 5000
+        assert sum(rule['objects'] for rule in manifest['rules']) == 5000
+        assert b''.join(f.read_bytes() for f in files) == reference
+
+
+
+@pytest.mark.p2
+def test_d006_arrow_ipc_file_reads_back():
+    """Test D006: Arrow IPC file reads back"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -j4 -t arrow -o {tmp}/out.arrow', tmp)
+        reference = [line.split('\t') for line in run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -k', tmp).decode().splitlines()]
+        path = str(Path(tmp) / 'out.arrow')
+
+        pa = pytest.importorskip('pyarrow')
+        table = pa.ipc.open_file(path).read_all()
+        rows = [list(row) for row in zip(*(column.to_pylist() for column in table.columns))]
+
+        assert len(rows) == len(reference) == 3000
+        assert rows == reference
+
+
+
+@pytest.mark.p2
+def test_d007_arrow_ipc_stream_reads_back():
+    """Test D007: Arrow IPC stream reads back"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -j4 -t arrows > {tmp}/out.arrows', tmp)
+        reference = [line.split('\t') for line in run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -k', tmp).decode().splitlines()]
+        path = str(Path(tmp) / 'out.arrows')
+
+        pa = pytest.importorskip('pyarrow')
+        table = pa.ipc.open_stream(path).read_all()
+        rows = [list(row) for row in zip(*(column.to_pylist() for column in table.columns))]
+
+        assert len(rows) == len(reference) == 3000
+        assert rows == reference
+
+
+
+@pytest.mark.p2
+def test_d008_parquet_reads_back():
+    """Test D008: Parquet reads back"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -j4 -t parquet -o {tmp}/out.parquet', tmp)
+        reference = [line.split('\t') for line in run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -k', tmp).decode().splitlines()]
+        path = str(Path(tmp) / 'out.parquet')
+
+        pq = pytest.importorskip('pyarrow.parquet')
+        table = pq.read_table(path)
+        rows = [list(row) for row in zip(*(column.to_pylist() for column in table.columns))]
+
+        assert len(rows) == len(reference) == 3000
+        assert rows == reference
+
+
+
+@pytest.mark.p2
+def test_d009_numpy_columns_read_back():
+    """Test D009: NumPy columns read back"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -j4 -t npy -o {tmp}/npy', tmp)
+        reference = [line.split('\t') for line in run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -k', tmp).decode().splitlines()]
+        path = str(Path(tmp) / 'npy')
+
+        layout = json.loads((Path(path) / 'datgen.json').read_text())
+        columns = [[column['labels'][code] for code in np.load(Path(path) / column['file'])]
+                   for column in layout['columns']]
+        rows = [list(row) for row in zip(*columns)]
+
+        assert len(rows) == len(reference) == 3000
+        assert rows == reference
+
+
+
+@pytest.mark.p2
+def test_d010_fixed_width_rows_read_back():
+    """Test D010: Fixed width rows read back"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -j4 -t rows -o {tmp}/out.rows', tmp)
+        reference = [line.split('\t') for line in run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 3000 -k', tmp).decode().splitlines()]
+        path = str(Path(tmp) / 'out.rows')
+
+        layout = json.loads(Path(path + '.json').read_text())
+        records = np.fromfile(path, np.uint8).reshape(layout['objects'], layout['record_size'])
+        order = '<' if layout['byte_order'] == 'little' else '>'
+        columns = []
+        for column in layout['columns']:
+            dtype = np.dtype(column['dtype']).newbyteorder(order)
+            codes = records[:, column['offset']:column['offset'] + dtype.itemsize].copy().view(dtype).ravel()
+            columns.append([column['labels'][code] for code in codes])
+        rows = [list(row) for row in zip(*columns)]
+
+        assert len(rows) == len(reference) == 3000
+        assert rows == reference
+
+
+
+@pytest.mark.p2
+def test_d011_timed_stream_under_a_rate_limit():
+    """Test D011: Timed stream under a rate limit"""
+
+    import json
+    import tempfile
+
+    src = Path(__file__).resolve().parents[2] / 'src'
+    if subprocess.run(['make', '-s', 'datgen'], cwd=src, capture_output=True).returncode != 0:
+        pytest.skip("src/datgen does not build")
+
+    def run(command, tmp):
+        result = subprocess.run(command.format(tmp=tmp), shell=True, cwd=src, capture_output=True)
+        assert result.returncode == 0, f"{command}: {result.stderr.decode()}"
+        return result.stdout
+
+    with tempfile.TemporaryDirectory() as tmp:
+
+        start = time.time()
+        lines = run('./datgen -R5 -A6 -I2 -d5/10 -s3 -O 2s -L 500', tmp).count(b'\n')
+        elapsed = time.time() - start
+        assert 600 <= lines <= 1100, f"{lines} lines"
+        assert elapsed < 10, f"{elapsed:.1f}s"
+